@@ -0,0 +1,298 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QObject>
+#include <QPluginLoader>
+#include <QSignalSpy>
+#include <QtTest>
+
+#include "../src/abstractbackend.h"
+#include "../src/backendmanager_p.h"
+#include "../src/config.h"
+#include "../src/configserializer_p.h"
+#include "../src/edidcache_p.h"
+#include "../src/output.h"
+
+using namespace KScreen;
+
+static const QByteArray s_edid = QByteArray::fromBase64(
+    "AP///////wBMLcMFMzJGRQkUAQMOMx14Ku6Ro1RMmSYPUFQjCACBAIFAgYCVAKlAswABAQEBAjqAGHE4LUBYLEUA/h8RAAAeAAAA/QA4PB5REQAKICAgICAgAAAA/ABTeW5jTWFzdGVyCiAgAAAA/wBIOU1aMzAyMTk2CiAgAC4=");
+
+// Replies to getConfigV2() as the launcher would, through the bus
+class ConfigSource : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.kscreen.TestConfigSource")
+
+public Q_SLOTS:
+    QByteArray getConfigV2()
+    {
+        return config;
+    }
+
+public:
+    QByteArray config;
+};
+
+// The launcher's notifications are fed to BackendManager by hand, so that the
+// order in which they and the replies to its requests arrive can be chosen.
+class TestBackendManager : public QObject
+{
+    Q_OBJECT
+
+private:
+    // The Fake backend's config with output 1 moved, as announced for @p generation
+    ConfigPtr configAt(quint64 generation) const;
+    QByteArray delta(quint64 baseGeneration, quint64 generation) const;
+
+    void sendConfig(quint64 generation);
+    void sendDelta(quint64 baseGeneration, quint64 generation);
+    void replyToFetch(quint64 generation);
+
+    QPluginLoader mLoader;
+    AbstractBackend *mBackend = nullptr;
+    ConfigSource mSource;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+    void testDeferredDecode();
+    void testUnknownBase_data();
+    void testUnknownBase();
+    void testDeltaCap();
+    void testRefetchRace();
+    void testCoalescedSwap();
+};
+
+ConfigPtr TestBackendManager::configAt(quint64 generation) const
+{
+    const ConfigPtr config = mBackend->config()->clone();
+    config->output(1)->setPos(QPoint(0, int(generation) * 10));
+    config->setSerial(generation);
+    return config;
+}
+
+QByteArray TestBackendManager::delta(quint64 baseGeneration, quint64 generation) const
+{
+    return ConfigSerializer::serializeConfigDelta(configAt(baseGeneration), configAt(generation));
+}
+
+void TestBackendManager::sendConfig(quint64 generation)
+{
+    QVERIFY(QMetaObject::invokeMethod(BackendManager::instance(),
+                                      "onBinaryConfigChanged",
+                                      Q_ARG(QByteArray, ConfigSerializer::serializeConfigBinary(configAt(generation), generation))));
+}
+
+void TestBackendManager::sendDelta(quint64 baseGeneration, quint64 generation)
+{
+    QVERIFY(QMetaObject::invokeMethod(BackendManager::instance(),
+                                      "onConfigDelta",
+                                      Q_ARG(qulonglong, baseGeneration),
+                                      Q_ARG(qulonglong, generation),
+                                      Q_ARG(QByteArray, delta(baseGeneration, generation))));
+}
+
+void TestBackendManager::replyToFetch(quint64 generation)
+{
+    mSource.config = ConfigSerializer::serializeConfigBinary(configAt(generation), generation);
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    const QDBusMessage call =
+        QDBusMessage::createMethodCall(bus.baseService(), QStringLiteral("/configsource"), QStringLiteral("org.kde.kscreen.TestConfigSource"), QStringLiteral("getConfigV2"));
+    auto *watcher = new QDBusPendingCallWatcher(bus.asyncCall(call));
+    watcher->waitForFinished();
+    QVERIFY(!watcher->isError());
+    QVERIFY(QMetaObject::invokeMethod(BackendManager::instance(), "onBinaryConfigReceived", Q_ARG(QDBusPendingCallWatcher *, watcher)));
+}
+
+void TestBackendManager::initTestCase()
+{
+    qputenv("KSCREEN_LOGGING", "false");
+    // Only the out-of-process method receives notifications, but no launcher
+    // is started: nothing here requests a backend
+    qputenv("KSCREEN_BACKEND_INPROCESS", "0");
+    QCOMPARE(BackendManager::instance()->method(), BackendManager::OutOfProcess);
+
+    mBackend = BackendManager::loadBackendPlugin(&mLoader, QStringLiteral("Fake"), {{QStringLiteral("TEST_DATA"), TEST_DATA "multipleoutput.json"}});
+    QVERIFY(mBackend);
+    QVERIFY(mBackend->config()->output(1));
+
+    ConfigSerializer::registerDBusTypes();
+    QVERIFY(QDBusConnection::sessionBus().registerObject(QStringLiteral("/configsource"), &mSource, QDBusConnection::ExportAllSlots));
+}
+
+void TestBackendManager::cleanupTestCase()
+{
+    delete mBackend;
+    mBackend = nullptr;
+}
+
+void TestBackendManager::cleanup()
+{
+    BackendManager::instance()->setConfig(ConfigPtr());
+}
+
+void TestBackendManager::testDeferredDecode()
+{
+    BackendManager *manager = BackendManager::instance();
+    QSignalSpy receivedSpy(manager, &BackendManager::configReceived);
+
+    sendConfig(10);
+    QCOMPARE(receivedSpy.count(), 1);
+    const ConfigPtr first = manager->config();
+    QVERIFY(first);
+    QCOMPARE(first->serial(), quint64(10));
+    QCOMPARE(first->output(1)->pos(), QPoint(0, 100));
+    // Decoded once, not for every call
+    QCOMPARE(manager->config(), first);
+
+    sendDelta(10, 11);
+    sendDelta(11, 12);
+    QCOMPARE(receivedSpy.count(), 3);
+    const ConfigPtr current = manager->config();
+    QCOMPARE(current->serial(), quint64(12));
+    QCOMPARE(current->output(1)->pos(), QPoint(0, 120));
+    QCOMPARE(current->output(2)->pos(), first->output(2)->pos());
+    // Whoever holds the previous config doesn't see it change
+    QCOMPARE(first->serial(), quint64(10));
+    QCOMPARE(first->output(1)->pos(), QPoint(0, 100));
+
+    // A full config replaces the deltas received before it
+    sendDelta(12, 13);
+    sendConfig(20);
+    QCOMPARE(manager->config()->serial(), quint64(20));
+    QCOMPARE(manager->config()->output(1)->pos(), QPoint(0, 200));
+}
+
+void TestBackendManager::testUnknownBase_data()
+{
+    QTest::addColumn<QList<quint64>>("deltas");
+
+    QTest::newRow("missed") << QList<quint64>({12, 13});
+    QTest::newRow("out of order") << QList<quint64>({11, 12, 10, 11});
+}
+
+void TestBackendManager::testUnknownBase()
+{
+    QFETCH(QList<quint64>, deltas);
+
+    BackendManager *manager = BackendManager::instance();
+    sendConfig(10);
+    QCOMPARE(manager->config()->serial(), quint64(10));
+
+    QSignalSpy receivedSpy(manager, &BackendManager::configReceived);
+    for (qsizetype i = 0; i < deltas.size(); i += 2) {
+        sendDelta(deltas[i], deltas[i + 1]);
+    }
+    // The config stays at the last state known for sure
+    const ConfigPtr config = manager->config();
+    QCOMPARE(config->serial(), quint64(10));
+    QCOMPARE(config->output(1)->pos(), QPoint(0, 100));
+
+    // ... until the refetch, which is announced like a change
+    QCoreApplication::processEvents();
+    const int notified = receivedSpy.count();
+    replyToFetch(13);
+    QCOMPARE(receivedSpy.count(), notified + 1);
+    QCOMPARE(manager->config()->serial(), quint64(13));
+    QCOMPARE(manager->config()->output(1)->pos(), QPoint(0, 130));
+
+    // Only fetches asked for by a resync are announced
+    replyToFetch(14);
+    QCOMPARE(receivedSpy.count(), notified + 1);
+    QCOMPARE(manager->config()->serial(), quint64(14));
+}
+
+void TestBackendManager::testDeltaCap()
+{
+    BackendManager *manager = BackendManager::instance();
+    sendConfig(10);
+    QCOMPARE(manager->config()->serial(), quint64(10));
+
+    // Nobody reads the config, the deltas are applied once 32 piled up
+    QSignalSpy receivedSpy(manager, &BackendManager::configReceived);
+    for (quint64 generation = 10; generation < 50; ++generation) {
+        sendDelta(generation, generation + 1);
+    }
+    QCOMPARE(receivedSpy.count(), 40);
+    QCOMPARE(manager->config()->serial(), quint64(50));
+    QCOMPARE(manager->config()->output(1)->pos(), QPoint(0, 500));
+
+    // Which notices a gap without anyone asking for the config: the refetch
+    // it triggers is announced
+    sendDelta(60, 61);
+    for (quint64 generation = 61; generation < 92; ++generation) {
+        sendDelta(generation, generation + 1);
+    }
+    QCOMPARE(receivedSpy.count(), 40 + 32);
+    QCoreApplication::processEvents();
+    replyToFetch(92);
+    QCOMPARE(receivedSpy.count(), 40 + 33);
+    QCOMPARE(manager->config()->serial(), quint64(92));
+
+    // Fewer don't get decoded behind the caller's back, so no refetch is
+    // asked for and the next reply isn't announced
+    sendDelta(92, 93);
+    sendDelta(94, 95);
+    QCoreApplication::processEvents();
+    replyToFetch(95);
+    QCOMPARE(receivedSpy.count(), 40 + 35);
+    QCOMPARE(manager->config()->serial(), quint64(95));
+    QCOMPARE(manager->config()->output(1)->pos(), QPoint(0, 950));
+}
+
+void TestBackendManager::testRefetchRace()
+{
+    BackendManager *manager = BackendManager::instance();
+    sendConfig(10);
+    QCOMPARE(manager->config()->serial(), quint64(10));
+
+    sendDelta(20, 21);
+    QCOMPARE(manager->config()->serial(), quint64(10));
+    QCoreApplication::processEvents();
+
+    // Changes announced while the refetch is in flight, the reply is at 22
+    sendDelta(21, 22);
+    sendDelta(22, 23);
+    replyToFetch(22);
+
+    // The delta the reply already contains is dropped, the later one applied
+    const ConfigPtr config = manager->config();
+    QCOMPARE(config->serial(), quint64(23));
+    QCOMPARE(config->output(1)->pos(), QPoint(0, 230));
+}
+
+void TestBackendManager::testCoalescedSwap()
+{
+    BackendManager *manager = BackendManager::instance();
+    EdidCache *cache = EdidCache::instance();
+    cache->clear();
+    const QVariantMap configMap = ConfigSerializer::serializeConfig(configAt(10)).toVariantMap();
+
+    QVERIFY(QMetaObject::invokeMethod(manager, "onConfigChanged", Q_ARG(QVariantMap, configMap)));
+    ConfigPtr config = manager->config()->clone();
+    QVERIFY(config->output(1)->isConnected());
+    QVERIFY(cache->restore(config).contains(1));
+    cache->insert(*config->output(1), s_edid);
+
+    // Unplugged and replugged with another monitor, which the launcher reported
+    // as one change: the output seems to have stayed connected
+    QVERIFY(QMetaObject::invokeMethod(manager, "onConfigChanged", Q_ARG(QVariantMap, configMap)));
+    config = manager->config()->clone();
+    QVERIFY(cache->restore(config).contains(1));
+    QVERIFY(!config->output(1)->edid());
+    cache->clear();
+}
+
+QTEST_GUILESS_MAIN(TestBackendManager)
+
+#include "testbackendmanager.moc"
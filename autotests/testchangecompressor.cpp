@@ -0,0 +1,152 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#include <QObject>
+#include <QSignalSpy>
+#include <QtTest>
+
+#include "../src/changecompressor_p.h"
+
+using namespace KScreen;
+
+class TestChangeCompressor : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void cleanup();
+
+    void testLeadingEdge();
+    void testBurst();
+    void testMaxLatency();
+    void testConfigure();
+    void testConfigureStage();
+};
+
+void TestChangeCompressor::cleanup()
+{
+    qunsetenv("KSCREEN_CHANGE_QUIET_PERIOD");
+    qunsetenv("KSCREEN_CHANGE_MAX_LATENCY");
+    qunsetenv("KSCREEN_CHANGE_LEADING_EDGE");
+    qunsetenv("KSCREEN_TEST_CHANGE_QUIET_PERIOD");
+}
+
+void TestChangeCompressor::testLeadingEdge()
+{
+    ChangeCompressor compressor(QStringLiteral("test"), 2000, 5000);
+    QSignalSpy triggeredSpy(&compressor, &ChangeCompressor::triggered);
+
+    // Reported right after returning to the event loop, not after the quiet period
+    compressor.notify();
+    compressor.notify();
+    QVERIFY(compressor.isPending());
+    QCOMPARE(triggeredSpy.count(), 0);
+    QVERIFY(triggeredSpy.wait(1000));
+    QCOMPARE(triggeredSpy.count(), 1);
+    QVERIFY(!compressor.isPending());
+
+    // Anything within the quiet period is held back
+    compressor.notify();
+    QVERIFY(!triggeredSpy.wait(200));
+    compressor.cancel();
+    QVERIFY(!compressor.isPending());
+
+    const QVariantMap statistics = compressor.statistics();
+    QCOMPARE(statistics.value(QStringLiteral("changes")).toULongLong(), quint64(3));
+    QCOMPARE(statistics.value(QStringLiteral("triggers")).toULongLong(), quint64(1));
+    const QVariantList counts = statistics.value(QStringLiteral("latencyCounts")).toList();
+    QCOMPARE(counts.size(), statistics.value(QStringLiteral("latencyBounds")).toList().size() + 1);
+    quint64 total = 0;
+    for (const QVariant &count : counts) {
+        total += count.toULongLong();
+    }
+    QCOMPARE(total, quint64(1));
+}
+
+void TestChangeCompressor::testBurst()
+{
+    ChangeCompressor compressor(QStringLiteral("test"), 100, 5000);
+    compressor.configure({{QStringLiteral("changeLeadingEdge"), 0}});
+    QVERIFY(!compressor.leadingEdge());
+    QSignalSpy triggeredSpy(&compressor, &ChangeCompressor::triggered);
+
+    for (int i = 0; i < 5; ++i) {
+        compressor.notify();
+        QTest::qWait(20);
+    }
+    QCOMPARE(triggeredSpy.count(), 0);
+    QVERIFY(triggeredSpy.wait(1000));
+    QTest::qWait(200);
+    QCOMPARE(triggeredSpy.count(), 1);
+}
+
+void TestChangeCompressor::testMaxLatency()
+{
+    ChangeCompressor compressor(QStringLiteral("test"), 200, 300);
+    compressor.configure({{QStringLiteral("changeLeadingEdge"), false}});
+    QSignalSpy triggeredSpy(&compressor, &ChangeCompressor::triggered);
+
+    // A change every 50 ms never leaves a quiet period, but must still be reported
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 1000) {
+        compressor.notify();
+        QTest::qWait(50);
+    }
+    QVERIFY(triggeredSpy.count() >= 2);
+    QVERIFY(compressor.statistics().value(QStringLiteral("latencyMax")).toLongLong() < 1000);
+}
+
+void TestChangeCompressor::testConfigure()
+{
+    ChangeCompressor compressor(QStringLiteral("test"), 100, 500);
+    QCOMPARE(compressor.objectName(), QStringLiteral("test"));
+    QCOMPARE(compressor.quietPeriod(), 100);
+    QCOMPARE(compressor.maxLatency(), 500);
+    QVERIFY(compressor.leadingEdge());
+
+    compressor.configure({{QStringLiteral("changeQuietPeriod"), 50}, {QStringLiteral("changeMaxLatency"), QStringLiteral("250")}});
+    QCOMPARE(compressor.quietPeriod(), 50);
+    QCOMPARE(compressor.maxLatency(), 250);
+
+    // Invalid values keep the current setting
+    compressor.configure({{QStringLiteral("changeQuietPeriod"), QStringLiteral("soon")}});
+    QCOMPARE(compressor.quietPeriod(), 50);
+
+    // The environment wins
+    qputenv("KSCREEN_CHANGE_QUIET_PERIOD", "30");
+    qputenv("KSCREEN_CHANGE_LEADING_EDGE", "0");
+    compressor.configure({{QStringLiteral("changeQuietPeriod"), 70}});
+    QCOMPARE(compressor.quietPeriod(), 30);
+    QCOMPARE(compressor.maxLatency(), 250);
+    QVERIFY(!compressor.leadingEdge());
+}
+
+void TestChangeCompressor::testConfigureStage()
+{
+    ChangeCompressor compressor(QStringLiteral("test"), 100, 500);
+    ChangeCompressor other(QStringLiteral("other"), 100, 500);
+
+    // The settings of a stage win over those shared by all
+    const QVariantMap arguments = {{QStringLiteral("changeQuietPeriod"), 50}, {QStringLiteral("testChangeQuietPeriod"), 20}};
+    compressor.configure(arguments);
+    other.configure(arguments);
+    QCOMPARE(compressor.quietPeriod(), 20);
+    QCOMPARE(other.quietPeriod(), 50);
+
+    // Also in the environment, which still wins over the arguments
+    qputenv("KSCREEN_CHANGE_QUIET_PERIOD", "30");
+    qputenv("KSCREEN_TEST_CHANGE_QUIET_PERIOD", "10");
+    compressor.configure(arguments);
+    other.configure(arguments);
+    QCOMPARE(compressor.quietPeriod(), 10);
+    QCOMPARE(other.quietPeriod(), 30);
+}
+
+QTEST_GUILESS_MAIN(TestChangeCompressor)
+
+#include "testchangecompressor.moc"
@@ -0,0 +1,242 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QObject>
+#include <QSignalSpy>
+#include <QtTest>
+
+#include "../src/backendmanager_p.h"
+#include "../src/config.h"
+#include "../src/confighistory.h"
+#include "../src/configmonitor.h"
+#include "../src/getconfigoperation.h"
+#include "../src/output.h"
+#include "../src/setconfigoperation.h"
+
+using namespace KScreen;
+
+// The monitors of multipleoutput.json
+static const QByteArray s_syncMasterEdid = QByteArray::fromBase64(
+    "AP///////wBMLcMFMzJGRQkUAQMOMx14Ku6Ro1RMmSYPUFQjCACBAIFAgYCVAKlAswABAQEBAjqAGHE4LUBYLEUA/h8RAAAeAAAA/QA4PB5REQAKICAgICAgAAAA/ABTeW5jTWFzdGVyCiAgAAAA/wBIOU1aMzAyMTk2CiAgAC4=");
+static const QByteArray s_dellEdid = QByteArray::fromBase64(
+    "AP///////wAQrBbwTExLQQ4WAQOANCB46h7Frk80sSYOUFSlSwCBgKlA0QBxTwEBAQEBAQEBKDyAoHCwI0AwIDYABkQhAAAaAAAA/wBGNTI1TTI0NUFLTEwKAAAA/ABERUxMIFUyNDEwCiAgAAAA/QA4TB5REQAKICAgICAgAToCAynxUJAFBAMCBxYBHxITFCAVEQYjCQcHZwMMABAAOC2DAQAA4wUDAQI6gBhxOC1AWCxFAAZEIQAAHgEdgBhxHBYgWCwlAAZEIQAAngEdAHJR0B4gbihVAAZEIQAAHowK0Iog4C0QED6WAAZEIQAAGAAAAAAAAAAAAAAAAAAAPg==");
+
+class TestConfigHistory : public QObject
+{
+    Q_OBJECT
+
+private:
+    ConfigPtr getConfig(ConfigOperation::Options options = ConfigOperation::NoOptions);
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testRecord();
+    void testCapacity();
+    void testRevert();
+    void testRevertOutOfProcess();
+};
+
+ConfigPtr TestConfigHistory::getConfig(ConfigOperation::Options options)
+{
+    auto *op = new GetConfigOperation(options);
+    if (!op->exec()) {
+        qWarning("ConfigOperation error: %s", qPrintable(op->errorString()));
+        return ConfigPtr();
+    }
+    return op->config();
+}
+
+void TestConfigHistory::initTestCase()
+{
+    qputenv("KSCREEN_LOGGING", "false");
+    qputenv("KSCREEN_BACKEND_INPROCESS", "1");
+    qputenv("KSCREEN_BACKEND", "Fake");
+    BackendManager::instance()->setMethod(BackendManager::InProcess);
+}
+
+void TestConfigHistory::init()
+{
+    BackendManager::instance()->setBackendArgs({{QStringLiteral("TEST_DATA"), TEST_DATA "multipleoutput.json"}});
+    ConfigHistory::instance()->setCapacity(5);
+}
+
+void TestConfigHistory::cleanup()
+{
+    ConfigHistory::instance()->setCapacity(0);
+    BackendManager::instance()->shutdownBackend();
+}
+
+void TestConfigHistory::testRecord()
+{
+    ConfigHistory *history = ConfigHistory::instance();
+    const ConfigPtr config = getConfig();
+    QVERIFY(config);
+
+    QSignalSpy recordedSpy(history, &ConfigHistory::recorded);
+    const quint64 first = history->record(config);
+    QVERIFY(first != 0);
+    QCOMPARE(recordedSpy.count(), 1);
+    QCOMPARE(history->latestGeneration(), first);
+    QCOMPARE(history->origin(first), ConfigHistory::Origin::Manual);
+
+    // The same state again is not a new entry
+    QCOMPARE(history->record(config, ConfigHistory::Origin::External), first);
+    QCOMPARE(history->record(config->clone()), first);
+    QCOMPARE(recordedSpy.count(), 1);
+
+    config->output(2)->setPos(QPoint(2000, 0));
+    const quint64 second = history->record(config, ConfigHistory::Origin::External);
+    QVERIFY(second > first);
+    QCOMPARE(recordedSpy.count(), 2);
+    QCOMPARE(history->origin(second), ConfigHistory::Origin::External);
+    QCOMPARE(history->generations(), QList<quint64>({first, second}));
+
+    // Entries are not affected by later changes of the recorded config
+    config->output(1)->setScale(3.0);
+    const ConfigPtr firstConfig = history->config(first);
+    QVERIFY(firstConfig);
+    QCOMPARE(firstConfig->output(1)->scale(), 1.0);
+    QCOMPARE(firstConfig->output(2)->pos(), QPoint(1280, 0));
+    const ConfigPtr secondConfig = history->config(second);
+    QCOMPARE(secondConfig->output(1)->scale(), 1.0);
+    QCOMPARE(secondConfig->output(2)->pos(), QPoint(2000, 0));
+
+    // ... nor by changes of the configs handed out
+    firstConfig->output(2)->setPos(QPoint(0, 1000));
+    QCOMPARE(history->config(first)->output(2)->pos(), QPoint(1280, 0));
+
+    QVERIFY(!history->config(second + 1));
+
+    // Outputs whose EDID wasn't fetched yet show the same monitors
+    const ConfigPtr withoutEdids = getConfig(ConfigOperation::NoEDID);
+    QVERIFY(withoutEdids);
+    QVERIFY(!withoutEdids->output(1)->edid());
+    QVERIFY(history->config(first)->output(1)->edid());
+    withoutEdids->output(2)->setPos(QPoint(2000, 0));
+    QCOMPARE(history->record(withoutEdids, ConfigHistory::Origin::Applied), second);
+
+    // Properties Output::diff() doesn't report make a new entry too
+    withoutEdids->output(2)->setFollowPreferredMode(!withoutEdids->output(2)->followPreferredMode());
+    const quint64 third = history->record(withoutEdids);
+    QVERIFY(third > second);
+    withoutEdids->output(2)->setSizeMm(withoutEdids->output(2)->sizeMm() + QSize(10, 10));
+    QVERIFY(history->record(withoutEdids) > third);
+    QCOMPARE(history->record(withoutEdids), history->latestGeneration());
+}
+
+void TestConfigHistory::testCapacity()
+{
+    ConfigHistory *history = ConfigHistory::instance();
+    const ConfigPtr config = getConfig();
+    QVERIFY(config);
+
+    QList<quint64> generations;
+    for (int i = 0; i < 8; ++i) {
+        config->output(1)->setPos(QPoint(0, i * 10));
+        generations << history->record(config);
+    }
+    QCOMPARE(history->generations(), generations.mid(3));
+    QVERIFY(!history->config(generations.first()));
+
+    history->setCapacity(2);
+    QCOMPARE(history->generations(), generations.mid(6));
+
+    history->setCapacity(0);
+    QVERIFY(history->generations().isEmpty());
+    QCOMPARE(history->latestGeneration(), quint64(0));
+    QCOMPARE(history->record(config), quint64(0));
+}
+
+void TestConfigHistory::testRevert()
+{
+    ConfigHistory *history = ConfigHistory::instance();
+    const ConfigPtr config = getConfig();
+    QVERIFY(config);
+
+    const quint64 original = history->record(config);
+    config->output(1)->setScale(2.0);
+    auto *setOp = new SetConfigOperation(config);
+    QVERIFY(setOp->exec());
+    QVERIFY(history->latestGeneration() > original);
+    QCOMPARE(history->config(history->latestGeneration())->output(1)->scale(), 2.0);
+
+    SetConfigOperation *revertOp = history->revertTo(original);
+    QVERIFY(revertOp);
+    QVERIFY(revertOp->exec());
+
+    const ConfigPtr reverted = getConfig();
+    QVERIFY(reverted);
+    QCOMPARE(reverted->output(1)->scale(), 1.0);
+    QCOMPARE(reverted->output(2)->scale(), 1.4);
+    QVERIFY(!reverted->diff(history->config(original)).affects(Output::Change::Geometry));
+
+    QVERIFY(!history->revertTo(history->latestGeneration() + 1));
+
+    // Nothing to revert when the monitors were swapped between the connectors
+    const quint64 latest = history->latestGeneration();
+    const ConfigPtr swapped = history->config(latest);
+    const QMap<int, QByteArray> swappedEdids = {{1, s_dellEdid}, {2, s_syncMasterEdid}};
+    for (auto it = swappedEdids.cbegin(); it != swappedEdids.cend(); ++it) {
+        const OutputPtr output = swapped->output(it.key());
+        OutputPtr other(new Output);
+        other->setId(output->id());
+        other->setName(output->name());
+        other->setConnected(true);
+        other->setEdid(it.value());
+        swapped->removeOutput(output->id());
+        swapped->addOutput(other);
+    }
+    QVERIFY(history->record(swapped) > latest);
+    QVERIFY(!history->revertTo(original));
+}
+
+void TestConfigHistory::testRevertOutOfProcess()
+{
+    QDBusConnectionInterface *bus = QDBusConnection::sessionBus().interface();
+    if (!bus->isServiceRegistered(QStringLiteral("org.kde.KScreen")) && !bus->startService(QStringLiteral("org.kde.KScreen")).isValid()) {
+        QSKIP("D-Bus service org.kde.KScreen could not be started");
+    }
+    qputenv("KSCREEN_BACKEND_INPROCESS", "0");
+    BackendManager::instance()->setMethod(BackendManager::OutOfProcess);
+    // The changes announced by the launcher are recorded too
+    ConfigMonitor *monitor = ConfigMonitor::instance();
+    QSignalSpy changedSpy(monitor, &ConfigMonitor::configurationChanged);
+
+    ConfigHistory *history = ConfigHistory::instance();
+    const ConfigPtr config = getConfig();
+    QVERIFY(config);
+    QVERIFY(config->output(1)->edid());
+    monitor->addConfig(config);
+
+    const quint64 original = history->record(config);
+    config->output(1)->setScale(2.0);
+    QVERIFY((new SetConfigOperation(config))->exec());
+    const quint64 applied = history->latestGeneration();
+    QVERIFY(applied > original);
+    QCOMPARE(history->origin(applied), ConfigHistory::Origin::Applied);
+
+    // The echo of our own change is the same state, with EDIDs or not
+    QTRY_VERIFY(!changedSpy.isEmpty());
+    QCOMPARE(history->latestGeneration(), applied);
+
+    // The current config comes from the launcher, without the EDIDs the entry has
+    SetConfigOperation *revertOp = history->revertTo(original);
+    QVERIFY(revertOp);
+    QVERIFY(revertOp->exec());
+    QCOMPARE(getConfig()->output(1)->scale(), 1.0);
+
+    monitor->removeConfig(config);
+}
+
+QTEST_GUILESS_MAIN(TestConfigHistory)
+
+#include "testconfighistory.moc"
@@ -65,6 +65,7 @@ private Q_SLOTS:
         // Prepare monitor
         KScreen::ConfigMonitor *monitor = KScreen::ConfigMonitor::instance();
         QSignalSpy spy(monitor, SIGNAL(configurationChanged()));
+        QSignalSpy changesSpy(monitor, &KScreen::ConfigMonitor::configChanged);
 
         // Get config and monitor it for changes
         KScreen::ConfigPtr config = getConfig();
@@ -82,6 +83,8 @@ private Q_SLOTS:
         QCOMPARE(spy.size(), 1);
         QCOMPARE(enabledSpy.size(), 1);
         QCOMPARE(config->output(1)->isEnabled(), false);
+        QCOMPARE(changesSpy.size(), 1);
+        QVERIFY(changesSpy.first().at(0).value<KScreen::ConfigPtr>() == config);
 
         output->setEnabled(false);
         auto setop2 = new KScreen::SetConfigOperation(config);
@@ -90,6 +93,69 @@ private Q_SLOTS:
         QTRY_VERIFY(!spy.isEmpty());
         QCOMPARE(spy.size(), 2);
     }
+
+    void testFilteredChangeNotify()
+    {
+        qputenv("KSCREEN_BACKEND_INPROCESS", "1");
+        KScreen::BackendManager::instance()->shutdownBackend();
+        KScreen::BackendManager::instance()->setMethod(KScreen::BackendManager::InProcess);
+        KScreen::BackendManager::instance()->setBackendArgs({{QStringLiteral("TEST_DATA"), TEST_DATA "multipleoutput.json"}});
+
+        KScreen::ConfigMonitor *monitor = KScreen::ConfigMonitor::instance();
+        const KScreen::ConfigPtr all = getConfig();
+        const KScreen::ConfigPtr geometry = getConfig();
+        const KScreen::ConfigPtr color = getConfig();
+        const KScreen::ConfigPtr secondOutput = getConfig();
+        monitor->addConfig(all);
+        monitor->addConfig(geometry, KScreen::ConfigMonitor::Interest::Geometry);
+        monitor->addConfig(color, KScreen::ConfigMonitor::Interest::Color);
+        monitor->addConfig(secondOutput, KScreen::ConfigMonitor::Interest::All, {2});
+
+        // Start from the config of this backend
+        QVERIFY((new KScreen::SetConfigOperation(getConfig()))->exec());
+
+        QSignalSpy changesSpy(monitor, &KScreen::ConfigMonitor::configChanged);
+        const auto updated = [&changesSpy]() {
+            QList<KScreen::ConfigPtr> configs;
+            for (const QList<QVariant> &arguments : std::as_const(changesSpy)) {
+                configs << arguments.at(0).value<KScreen::ConfigPtr>();
+            }
+            changesSpy.clear();
+            return configs;
+        };
+
+        // Layout change of the first output
+        KScreen::ConfigPtr config = getConfig();
+        config->output(1)->setScale(2.0);
+        QVERIFY((new KScreen::SetConfigOperation(config))->exec());
+        QTRY_VERIFY(!changesSpy.isEmpty());
+        QList<KScreen::ConfigPtr> configs = updated();
+        QCOMPARE(configs.size(), 2);
+        QVERIFY(configs.contains(all));
+        QVERIFY(configs.contains(geometry));
+        QCOMPARE(geometry->output(1)->scale(), 2.0);
+        QCOMPARE(color->output(1)->scale(), 1.0);
+
+        // Color change of the second output
+        config = getConfig();
+        config->output(2)->setHdrEnabled(true);
+        QVERIFY((new KScreen::SetConfigOperation(config))->exec());
+        QTRY_VERIFY(!changesSpy.isEmpty());
+        configs = updated();
+        QCOMPARE(configs.size(), 3);
+        QVERIFY(configs.contains(all));
+        QVERIFY(configs.contains(color));
+        QVERIFY(configs.contains(secondOutput));
+        QVERIFY(color->output(2)->isHdrEnabled());
+        QVERIFY(!geometry->output(2)->isHdrEnabled());
+        // Skipped changes are caught up with
+        QCOMPARE(color->output(1)->scale(), 2.0);
+
+        monitor->removeConfig(all);
+        monitor->removeConfig(geometry);
+        monitor->removeConfig(color);
+        monitor->removeConfig(secondOutput);
+    }
 };
 
 QTEST_MAIN(TestConfigMonitor)
@@ -5,17 +5,80 @@
  *
  */
 
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusVariant>
 #include <QObject>
 #include <QtTest>
 #include <cstdint>
 #include <utility>
 
+#include "../src/config.h"
 #include "../src/configserializer_p.h"
+#include "../src/edid.h"
+#include "../src/edidcache_p.h"
 #include "../src/mode.h"
 #include "../src/output.h"
 #include "../src/screen.h"
 #include "../src/types.h"
 
+// Writes down everything a client can see of a marshalled value: the D-Bus
+// signatures, value types, values and their order
+static QString dumpDBusValue(const QVariant &value)
+{
+    if (value.metaType() != QMetaType::fromType<QDBusArgument>()) {
+        return QStringLiteral("%1:%2").arg(QString::fromLatin1(value.typeName()), value.toString());
+    }
+
+    const QDBusArgument arg = value.value<QDBusArgument>();
+    QString dump = arg.currentSignature() + QLatin1Char('[');
+    if (arg.currentType() == QDBusArgument::MapType) {
+        arg.beginMap();
+        while (!arg.atEnd()) {
+            QString key;
+            QDBusVariant entry;
+            arg.beginMapEntry();
+            arg >> key >> entry;
+            arg.endMapEntry();
+            dump += key + QLatin1Char('=') + dumpDBusValue(entry.variant()) + QLatin1Char(',');
+        }
+        arg.endMap();
+    } else if (arg.currentType() == QDBusArgument::ArrayType) {
+        arg.beginArray();
+        while (!arg.atEnd()) {
+            QDBusVariant entry;
+            arg >> entry;
+            dump += dumpDBusValue(entry.variant()) + QLatin1Char(',');
+        }
+        arg.endArray();
+    } else {
+        dump += QStringLiteral("unexpected");
+    }
+    return dump + QLatin1Char(']');
+}
+
+// Messages sent to ourselves are marshalled and demarshalled like any other,
+// this gives us values in the form the deserializers get them from the bus
+class DBusLoopback : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.kscreen.TestLoopback")
+
+public Q_SLOTS:
+    QString dump(const QDBusVariant &value)
+    {
+        return dumpDBusValue(value.variant());
+    }
+
+    void receive(const QVariantMap &map)
+    {
+        received = map;
+    }
+
+public:
+    QVariantMap received;
+};
+
 class TestConfigSerializer : public QObject
 {
     Q_OBJECT
@@ -25,7 +88,67 @@ public:
     {
     }
 
+private:
+    QDBusMessage callLoopback(const QString &method, const QVariant &arg)
+    {
+        QDBusConnection bus = QDBusConnection::sessionBus();
+        QDBusMessage call = QDBusMessage::createMethodCall(bus.baseService(), QStringLiteral("/loopback"), QStringLiteral("org.kde.kscreen.TestLoopback"), method);
+        call << arg;
+        return bus.call(call);
+    }
+
+    // The config as deserializeConfig() gets it from the bus
+    QVariantMap receivedConfigMap(const KScreen::ConfigPtr &config)
+    {
+        callLoopback(QStringLiteral("receive"), KScreen::ConfigSerializer::serializeConfig(config).toVariantMap());
+        return mLoopback.received;
+    }
+
+    KScreen::ConfigPtr createConfig(int outputCount, int modeCount)
+    {
+        KScreen::ScreenPtr screen(new KScreen::Screen);
+        screen->setId(1);
+        screen->setMinSize(QSize(320, 200));
+        screen->setMaxSize(QSize(8192, 8192));
+        screen->setCurrentSize(QSize(1920 * outputCount, 1080));
+        screen->setMaxActiveOutputsCount(outputCount);
+
+        KScreen::ConfigPtr config(new KScreen::Config);
+        config->setScreen(screen);
+        for (int id = 1; id <= outputCount; ++id) {
+            KScreen::ModeList modes;
+            for (int i = 0; i < modeCount; ++i) {
+                KScreen::ModePtr mode(new KScreen::Mode);
+                mode->setId(QString::number(i));
+                mode->setName(QStringLiteral("%1x%2").arg(640 + i * 8).arg(480 + i * 4));
+                mode->setSize(QSize(640 + i * 8, 480 + i * 4));
+                mode->setRefreshRate(60);
+                modes.insert(mode->id(), mode);
+            }
+
+            KScreen::OutputPtr output(new KScreen::Output);
+            output->setId(id);
+            output->setName(QStringLiteral("DP-%1").arg(id));
+            output->setModes(modes);
+            output->setCurrentModeId(QStringLiteral("0"));
+            output->setPreferredModes({QStringLiteral("0")});
+            output->setConnected(true);
+            output->setEnabled(true);
+            output->setPos(QPoint((id - 1) * 1920, 0));
+            config->addOutput(output);
+        }
+        return config;
+    }
+
+    DBusLoopback mLoopback;
+
 private Q_SLOTS:
+    void initTestCase()
+    {
+        KScreen::ConfigSerializer::registerDBusTypes();
+        QVERIFY(QDBusConnection::sessionBus().registerObject(QStringLiteral("/loopback"), &mLoopback, QDBusConnection::ExportAllSlots));
+    }
+
     void testSerializePoint()
     {
         const QPoint point(42, 24);
@@ -173,6 +296,384 @@ private Q_SLOTS:
         QCOMPARE(sizeMm[QLatin1String("width")].toInt(), output->sizeMm().width());
         QCOMPARE(sizeMm[QLatin1String("height")].toInt(), output->sizeMm().height());
     }
+
+    void testDBusConfigWireFormat()
+    {
+        KScreen::ConfigSerializer::registerDBusTypes();
+
+        KScreen::ScreenPtr screen(new KScreen::Screen);
+        screen->setId(1);
+        screen->setMinSize(QSize(320, 200));
+        screen->setMaxSize(QSize(8192, 8192));
+        screen->setCurrentSize(QSize(3200, 1080));
+        screen->setMaxActiveOutputsCount(2);
+
+        KScreen::ConfigPtr config(new KScreen::Config);
+        config->setScreen(screen);
+        config->setSupportedFeatures(KScreen::Config::Feature::Writable | KScreen::Config::Feature::PerOutputScaling);
+        config->setTabletModeAvailable(true);
+
+        for (int id = 1; id <= 2; ++id) {
+            KScreen::ModeList modes;
+            for (int i = 0; i < 2; ++i) {
+                KScreen::ModePtr mode(new KScreen::Mode);
+                mode->setId(QString::number(i));
+                mode->setName(QStringLiteral("1920x1080"));
+                mode->setSize(QSize(1920, 1080));
+                mode->setRefreshRate(59.94 + i);
+                modes.insert(mode->id(), mode);
+            }
+
+            KScreen::OutputPtr output(new KScreen::Output);
+            output->setId(id);
+            output->setName(QStringLiteral("DP-%1").arg(id));
+            output->setType(KScreen::Output::DisplayPort);
+            output->setModes(modes);
+            output->setCurrentModeId(QStringLiteral("1"));
+            output->setPreferredModes({QStringLiteral("0"), QStringLiteral("1")});
+            output->setPos(QPoint((id - 1) * 1920, 0));
+            output->setSize(QSize(1920, 1080));
+            output->setScale(id == 1 ? 1.0 : 1.25);
+            output->setConnected(true);
+            output->setEnabled(id == 1);
+            output->setPriority(id);
+            output->setClones({3, 4});
+            output->setSizeMm(QSize(530, 300));
+            output->setReplicationSource(0);
+            if (id == 2) {
+                output->setCapabilities(KScreen::Output::Capability::Overscan | KScreen::Output::Capability::Vrr | KScreen::Output::Capability::RgbRange
+                                        | KScreen::Output::Capability::HighDynamicRange | KScreen::Output::Capability::WideColorGamut);
+                output->setOverscan(5);
+                output->setVrrPolicy(KScreen::Output::VrrPolicy::Automatic);
+                output->setRgbRange(KScreen::Output::RgbRange::Full);
+                output->setHdrEnabled(true);
+                output->setSdrBrightness(300);
+                output->setWcgEnabled(true);
+            }
+            config->addOutput(output);
+        }
+
+        const auto dump = [this](const QVariant &value) {
+            return callLoopback(QStringLiteral("dump"), QVariant::fromValue(QDBusVariant(value))).arguments().value(0).toString();
+        };
+
+        const QString expected = dump(KScreen::ConfigSerializer::serializeConfig(config).toVariantMap());
+        QVERIFY(expected.startsWith(QLatin1String("a{sv}[features=qlonglong:")));
+        QCOMPARE(dump(QVariant::fromValue(KScreen::ConfigSerializer::DBusConfig{config})), expected);
+
+        // Marshalled once, sent several times
+        const QVariant marshalled = KScreen::ConfigSerializer::marshalConfig(config);
+        QCOMPARE(dump(marshalled), expected);
+        QCOMPARE(dump(marshalled), expected);
+        QCOMPARE(callLoopback(QStringLiteral("receive"), marshalled).type(), QDBusMessage::ReplyMessage);
+        QCOMPARE(KScreen::ConfigSerializer::deserializeConfig(mLoopback.received)->outputs().count(), 2);
+
+        // Every key the serializer writes is understood by the deserializer
+        const KScreen::ConfigPtr result = KScreen::ConfigSerializer::deserializeConfig(receivedConfigMap(config));
+        QVERIFY(result);
+        QCOMPARE(result->outputs().count(), 2);
+        const KScreen::OutputPtr output = result->output(2);
+        QCOMPARE(output->name(), QStringLiteral("DP-2"));
+        QCOMPARE(output->scale(), 1.25);
+        QCOMPARE(output->priority(), 2u);
+        QCOMPARE(output->clones(), QList<int>({3, 4}));
+        QCOMPARE(output->preferredModes(), QStringList({QStringLiteral("0"), QStringLiteral("1")}));
+        QCOMPARE(output->modes().count(), 2);
+        QCOMPARE(output->overscan(), 5u);
+        QCOMPARE(output->vrrPolicy(), KScreen::Output::VrrPolicy::Automatic);
+        QCOMPARE(output->isHdrEnabled(), true);
+        QCOMPARE(output->sdrBrightness(), 300u);
+        QCOMPARE(output->isWcgEnabled(), true);
+        QCOMPARE(result->screen()->maxActiveOutputsCount(), 2);
+    }
+
+    void testDeserializeUnknownKeys()
+    {
+        const KScreen::ConfigPtr config = createConfig(1, 1);
+        QVariantMap map = KScreen::ConfigSerializer::serializeConfig(config).toVariantMap();
+
+        // Unknown config keys are ignored...
+        map.insert(QStringLiteral("fromTheFuture"), true);
+        callLoopback(QStringLiteral("receive"), map);
+        QVERIFY(KScreen::ConfigSerializer::deserializeConfig(mLoopback.received));
+
+        // ... but unknown output keys make the whole config invalid
+        QVariantList outputs = map.value(QStringLiteral("outputs")).toList();
+        QVariantMap output = outputs.first().toMap();
+        output.insert(QStringLiteral("fromTheFuture"), true);
+        outputs[0] = output;
+        map.insert(QStringLiteral("outputs"), outputs);
+        callLoopback(QStringLiteral("receive"), map);
+        QVERIFY(!KScreen::ConfigSerializer::deserializeConfig(mLoopback.received));
+    }
+
+    void benchmarkDeserializeConfig_data()
+    {
+        QTest::addColumn<int>("modeCount");
+
+        QTest::newRow("10 modes") << 10;
+        QTest::newRow("100 modes") << 100;
+        QTest::newRow("500 modes") << 500;
+    }
+
+    void benchmarkDeserializeConfig()
+    {
+        QFETCH(int, modeCount);
+
+        const QVariantMap map = receivedConfigMap(createConfig(4, modeCount));
+        QVERIFY(!map.isEmpty());
+
+        KScreen::ConfigPtr config;
+        QBENCHMARK {
+            config = KScreen::ConfigSerializer::deserializeConfig(map);
+        }
+        QVERIFY(config);
+        QCOMPARE(config->output(1)->modes().count(), modeCount);
+    }
+
+    void testSerializeConfigBinary()
+    {
+        KScreen::ScreenPtr screen(new KScreen::Screen);
+        screen->setId(3);
+        screen->setMinSize(QSize(320, 200));
+        screen->setMaxSize(QSize(8192, 8192));
+        screen->setCurrentSize(QSize(2880, 1024));
+        screen->setMaxActiveOutputsCount(4);
+
+        KScreen::ModeList modes;
+        for (int i = 0; i < 3; ++i) {
+            KScreen::ModePtr mode(new KScreen::Mode);
+            mode->setId(QString::number(i));
+            mode->setName(QStringLiteral("1600x900"));
+            mode->setSize(QSize(1600, 900));
+            mode->setRefreshRate(59.9 + i);
+            modes.insert(mode->id(), mode);
+        }
+
+        KScreen::OutputPtr output(new KScreen::Output);
+        output->setId(60);
+        output->setName(QStringLiteral("DP-1"));
+        output->setType(KScreen::Output::DisplayPort);
+        output->setModes(modes);
+        output->setCurrentModeId(QStringLiteral("1"));
+        output->setPreferredModes({QStringLiteral("1")});
+        output->setPos(QPoint(1280, 0));
+        output->setScale(1.5);
+        output->setRotation(KScreen::Output::Left);
+        output->setConnected(true);
+        output->setEnabled(true);
+        output->setPriority(1);
+        output->setClones({50});
+        output->setSizeMm(QSize(310, 250));
+        output->setCapabilities(KScreen::Output::Capability::Vrr);
+        output->setVrrPolicy(KScreen::Output::VrrPolicy::Automatic);
+
+        KScreen::ConfigPtr config(new KScreen::Config);
+        config->setScreen(screen);
+        config->setSupportedFeatures(KScreen::Config::Feature::Writable | KScreen::Config::Feature::PerOutputScaling);
+        config->setTabletModeAvailable(true);
+        config->addOutput(output);
+
+        const QByteArray data = KScreen::ConfigSerializer::serializeConfigBinary(config, 42);
+        QVERIFY(!data.isEmpty());
+
+        const KScreen::ConfigPtr result = KScreen::ConfigSerializer::deserializeConfigBinary(data);
+        QVERIFY(result);
+        QCOMPARE(result->serial(), Q_UINT64_C(42));
+        QCOMPARE(result->clone()->serial(), Q_UINT64_C(42));
+        QCOMPARE(result->supportedFeatures(), config->supportedFeatures());
+        QCOMPARE(result->tabletModeAvailable(), true);
+        QCOMPARE(result->tabletModeEngaged(), false);
+        QCOMPARE(result->screen()->id(), screen->id());
+        QCOMPARE(result->screen()->currentSize(), screen->currentSize());
+        QCOMPARE(result->screen()->maxSize(), screen->maxSize());
+        QCOMPARE(result->screen()->maxActiveOutputsCount(), screen->maxActiveOutputsCount());
+
+        QCOMPARE(result->outputs().count(), 1);
+        const KScreen::OutputPtr resultOutput = result->output(60);
+        QVERIFY(resultOutput);
+        QCOMPARE(resultOutput->name(), output->name());
+        QCOMPARE(resultOutput->type(), output->type());
+        QCOMPARE(resultOutput->currentModeId(), output->currentModeId());
+        QCOMPARE(resultOutput->preferredModes(), output->preferredModes());
+        QCOMPARE(resultOutput->pos(), output->pos());
+        QCOMPARE(resultOutput->scale(), output->scale());
+        QCOMPARE(resultOutput->rotation(), output->rotation());
+        QCOMPARE(resultOutput->isEnabled(), true);
+        QCOMPARE(resultOutput->priority(), 1u);
+        QCOMPARE(resultOutput->clones(), output->clones());
+        QCOMPARE(resultOutput->sizeMm(), output->sizeMm());
+        QCOMPARE(resultOutput->capabilities(), output->capabilities());
+        QCOMPARE(resultOutput->vrrPolicy(), output->vrrPolicy());
+        QCOMPARE(resultOutput->modes().count(), modes.count());
+        for (const KScreen::ModePtr &mode : std::as_const(modes)) {
+            const KScreen::ModePtr resultMode = resultOutput->mode(mode->id());
+            QVERIFY(resultMode);
+            QCOMPARE(resultMode->name(), mode->name());
+            QCOMPARE(resultMode->size(), mode->size());
+            QCOMPARE(resultMode->refreshRate(), mode->refreshRate());
+        }
+
+        // Truncated or foreign data must be rejected rather than half-parsed
+        QVERIFY(!KScreen::ConfigSerializer::deserializeConfigBinary(data.left(data.size() - 4)));
+        QVERIFY(!KScreen::ConfigSerializer::deserializeConfigBinary(QByteArray("garbage")));
+    }
+
+    void testConfigDelta()
+    {
+        KScreen::ScreenPtr screen(new KScreen::Screen);
+        screen->setMaxSize(QSize(8192, 8192));
+
+        KScreen::ConfigPtr base(new KScreen::Config);
+        base->setScreen(screen);
+        for (int id = 1; id <= 3; ++id) {
+            KScreen::ModePtr mode(new KScreen::Mode);
+            mode->setId(QStringLiteral("1"));
+            mode->setSize(QSize(1920, 1080));
+            mode->setRefreshRate(60);
+
+            KScreen::OutputPtr output(new KScreen::Output);
+            output->setId(id);
+            output->setName(QStringLiteral("DP-%1").arg(id));
+            output->setModes({{mode->id(), mode}});
+            output->setCurrentModeId(mode->id());
+            output->setConnected(true);
+            output->setEnabled(true);
+            output->setPos(QPoint((id - 1) * 1920, 0));
+            base->addOutput(output);
+        }
+
+        // Nothing changed, nothing to send
+        QVERIFY(KScreen::ConfigSerializer::serializeConfigDelta(base, base->clone()).isEmpty());
+
+        KScreen::ConfigPtr changed = base->clone();
+        changed->output(1)->setPos(QPoint(0, 1080));
+        changed->output(2)->setScale(2.0);
+        changed->removeOutput(3);
+        KScreen::OutputPtr added(new KScreen::Output);
+        added->setId(4);
+        added->setName(QStringLiteral("HDMI-1"));
+        added->setConnected(true);
+        changed->addOutput(added);
+        changed->setTabletModeEngaged(true);
+
+        const QByteArray delta = KScreen::ConfigSerializer::serializeConfigDelta(base, changed);
+        QVERIFY(!delta.isEmpty());
+        // Only the touched properties are sent, not whole outputs and their modes
+        QVERIFY(delta.size() < KScreen::ConfigSerializer::serializeConfigBinary(changed).size());
+
+        KScreen::ConfigPtr result = base->clone();
+        QVERIFY(KScreen::ConfigSerializer::applyConfigDelta(result, delta));
+        QCOMPARE(result->outputs().count(), 3);
+        QCOMPARE(result->output(1)->pos(), QPoint(0, 1080));
+        QCOMPARE(result->output(1)->modes().count(), 1);
+        QCOMPARE(result->output(2)->scale(), 2.0);
+        QCOMPARE(result->output(2)->pos(), QPoint(1920, 0));
+        QVERIFY(!result->output(3));
+        QCOMPARE(result->output(4)->name(), QStringLiteral("HDMI-1"));
+        QCOMPARE(result->tabletModeEngaged(), true);
+
+        // Deltas carry absolute values, applying one twice doesn't hurt
+        QVERIFY(KScreen::ConfigSerializer::applyConfigDelta(result, delta));
+        QCOMPARE(result->outputs().count(), 3);
+        QCOMPARE(result->output(1)->pos(), QPoint(0, 1080));
+
+        // A delta against a config that lacks a changed output can't be applied
+        KScreen::ConfigPtr unrelated(new KScreen::Config);
+        QVERIFY(!KScreen::ConfigSerializer::applyConfigDelta(unrelated, delta));
+    }
+
+    void testBinaryEdidHash()
+    {
+        const QByteArray edidData = QByteArray::fromBase64(
+            "AP///////wAN8iw0AAAAABwVAQOAHRB4CoPVlFdSjCccUFQAAAABAQEBAQEBAQEBAQEBAQEBEhtWWlAAGTAwIDYAJaQQAAAYEhtWWlAAGTAwIDYAJaQQAAAYAAAA/"
+            "gBBVU8KICAgICAgICAgAAAA/gBCMTMzWFcwMyBWNCAKAIc=");
+
+        KScreen::OutputPtr output(new KScreen::Output);
+        output->setId(1);
+        output->setName(QStringLiteral("eDP-1"));
+        output->setConnected(true);
+        output->setEdid(edidData);
+        QVERIFY(output->edid()->isValid());
+
+        KScreen::ConfigPtr config(new KScreen::Config);
+        config->addOutput(output);
+        const QByteArray data = KScreen::ConfigSerializer::serializeConfigBinary(config);
+
+        // Unknown EDID: the client has to fetch it
+        KScreen::EdidCache::instance()->clear();
+        KScreen::ConfigPtr result = KScreen::ConfigSerializer::deserializeConfigBinary(data);
+        QVERIFY(result);
+        QVERIFY(!result->output(1)->edid());
+
+        // Known EDID: taken from the cache by its hash
+        KScreen::EdidCache::instance()->insert(edidData);
+        result = KScreen::ConfigSerializer::deserializeConfigBinary(data);
+        QVERIFY(result);
+        QVERIFY(result->output(1)->edid());
+        QCOMPARE(result->output(1)->edid()->hash(), output->edid()->hash());
+        QCOMPARE(result->output(1)->edid()->name(), output->edid()->name());
+
+        // The sender may pass the hash instead of loading the EDID, like the launcher
+        KScreen::OutputPtr bare(new KScreen::Output);
+        bare->setId(1);
+        bare->setName(QStringLiteral("eDP-1"));
+        bare->setConnected(true);
+        KScreen::ConfigPtr bareConfig(new KScreen::Config);
+        bareConfig->addOutput(bare);
+        const KScreen::ConfigSerializer::EdidHashes hashes = {{1, output->edid()->hash().toLatin1()}};
+        QCOMPARE(KScreen::ConfigSerializer::serializeConfigBinary(bareConfig, 0, KScreen::ConfigSerializer::NoWireCapabilities, hashes), data);
+        QVERIFY(!bare->edid());
+
+        // ... also in deltas, where a changed hash sends the output in full
+        KScreen::ConfigPtr changed = bareConfig->clone();
+        const QByteArray delta = KScreen::ConfigSerializer::serializeConfigDelta(bareConfig, changed, {{1, QByteArrayLiteral("previous")}}, hashes);
+        QVERIFY(!delta.isEmpty());
+        result = bareConfig->clone();
+        QVERIFY(KScreen::ConfigSerializer::applyConfigDelta(result, delta));
+        QCOMPARE(result->output(1)->edid()->hash(), output->edid()->hash());
+        QVERIFY(KScreen::ConfigSerializer::serializeConfigDelta(bareConfig, changed, hashes, hashes).isEmpty());
+
+        KScreen::EdidCache::instance()->clear();
+    }
+
+    void testBinaryModeTable()
+    {
+        // A video wall: eight panels of the same model
+        const KScreen::ConfigPtr config = createConfig(8, 60);
+        config->output(8)->setModes({});
+
+        const QByteArray inlineModes = KScreen::ConfigSerializer::serializeConfigBinary(config, 7);
+        const QByteArray modeTable = KScreen::ConfigSerializer::serializeConfigBinary(config, 7, KScreen::ConfigSerializer::SharedModeTable);
+        QVERIFY(modeTable.size() * 4 < inlineModes.size());
+
+        for (const QByteArray &data : {inlineModes, modeTable}) {
+            const KScreen::ConfigPtr result = KScreen::ConfigSerializer::deserializeConfigBinary(data);
+            QVERIFY(result);
+            QCOMPARE(result->serial(), Q_UINT64_C(7));
+            QCOMPARE(result->outputs().count(), 8);
+            for (const KScreen::OutputPtr &output : config->outputs()) {
+                const KScreen::ModeList modes = result->output(output->id())->modes();
+                QCOMPARE(modes.count(), output->modes().count());
+                for (const KScreen::ModePtr &mode : output->modes()) {
+                    QVERIFY(modes.contains(mode->id()));
+                    QCOMPARE(modes[mode->id()]->name(), mode->name());
+                    QCOMPARE(modes[mode->id()]->size(), mode->size());
+                    QCOMPARE(modes[mode->id()]->refreshRate(), mode->refreshRate());
+                }
+            }
+        }
+
+        // Identical mode lists come out as one shared list
+        const KScreen::ConfigPtr result = KScreen::ConfigSerializer::deserializeConfigBinary(modeTable);
+        QCOMPARE(result->output(1)->modeInfos().constData(), result->output(2)->modeInfos().constData());
+
+        // References past the end of the table are rejected
+        QByteArray corrupt = modeTable;
+        corrupt.replace(QByteArray::fromHex("0000003c00000000000000010000000200000003"), QByteArray::fromHex("0000003c00000000000000010000000200000fff"));
+        QVERIFY(corrupt != modeTable);
+        QVERIFY(!KScreen::ConfigSerializer::deserializeConfigBinary(corrupt));
+    }
 };
 
 QTEST_MAIN(TestConfigSerializer)
@@ -8,7 +8,11 @@
 #include <QObject>
 #include <QtTest>
 
+#include "../src/config.h"
+#include "../src/configserializer_p.h"
 #include "../src/edid.h"
+#include "../src/edidcache_p.h"
+#include "../src/output.h"
 
 using namespace KScreen;
 
@@ -20,8 +24,30 @@ private Q_SLOTS:
     void testInvalid();
     void testEdidParser_data();
     void testEdidParser();
+    void testEdidCache();
+    void testEdidCacheBound();
+    void testEdidCacheSwap();
 };
 
+static const QByteArray s_corEdid = QByteArray::fromBase64(
+    "AP///////wAN8iw0AAAAABwVAQOAHRB4CoPVlFdSjCccUFQAAAABAQEBAQEBAQEBAQEBAQEBEhtWWlAAGTAwIDYAJaQQAAAYEhtWWlAAGTAwIDYAJaQQAAAYAAAA/"
+    "gBBVU8KICAgICAgICAgAAAA/gBCMTMzWFcwMyBWNCAKAIc=");
+
+static const QByteArray s_dellEdid = QByteArray::fromBase64(
+    "AP///////wAQrBbwTExLQQ4WAQOANCB46h7Frk80sSYOUFSlSwCBgKlA0QBxTwEBAQEBAQEBKDyAoHCwI0AwIDYABkQhAAAaAAAA/wBGNTI1TTI0NUFLTEwKAAAA/ABERUxMIFUyNDEwCiAgAAAA/"
+    "QA4TB5REQAKICAgICAgAToCAynxUJAFBAMCBxYBHxITFCAVEQYjCQcHZwMMABAAOC2DAQAA4wUDAQI6gBhxOC1AWCxFAAZEIQAAHgEdgBhxHBYgWCwlAAZEIQAAngEdAHJR0B4gbihVAAZEIQAAHowK0Iog4C0QED6WAAZEIQAAGAAAAAAAAAAAAAAAAAAAPg==");
+
+static ConfigPtr configWithOutput(int id, bool connected)
+{
+    OutputPtr output(new Output);
+    output->setId(id);
+    output->setName(QStringLiteral("DP-%1").arg(id));
+    output->setConnected(connected);
+    ConfigPtr config(new Config);
+    config->addOutput(output);
+    return config;
+}
+
 void TestEdid::testInvalid()
 {
     QScopedPointer<Edid> e(new Edid());
@@ -159,6 +185,127 @@ void TestEdid::testEdidParser()
     QVERIFY(qFuzzyCompare(e->white(), white));
 }
 
+void TestEdid::testEdidCache()
+{
+    EdidCache *cache = EdidCache::instance();
+    cache->clear();
+
+    // First seen: has to be fetched
+    ConfigPtr config = configWithOutput(1, true);
+    QCOMPARE(cache->restore(config), QList<int>({1}));
+    QCOMPARE(cache->misses(), quint64(1));
+    cache->insert(*config->output(1), s_corEdid);
+    QVERIFY(config->output(1)->edid());
+    const QString hash = config->output(1)->edid()->hash();
+
+    // Still connected: parsed EDID is reused
+    config = configWithOutput(1, true);
+    QVERIFY(cache->restore(config).isEmpty());
+    QCOMPARE(cache->hits(), quint64(1));
+    QVERIFY(config->output(1)->edid());
+    QCOMPARE(config->output(1)->edid()->hash(), hash);
+    QCOMPARE(config->output(1)->hash(), hash);
+
+    // Unplugged and plugged in again, maybe another monitor
+    QVERIFY(cache->restore(configWithOutput(1, false)).isEmpty());
+    config = configWithOutput(1, true);
+    QCOMPARE(cache->restore(config), QList<int>({1}));
+    QVERIFY(!config->output(1)->edid());
+    QCOMPARE(cache->misses(), quint64(2));
+
+    // Gone from the config counts as disconnected too
+    cache->insert(*config->output(1), s_corEdid);
+    QCOMPARE(cache->restore(configWithOutput(2, true)), QList<int>({2}));
+    QCOMPARE(cache->restore(configWithOutput(1, true)), QList<int>({1}));
+
+    // Known by its hash, e.g. from a binary config
+    OutputPtr output(new Output);
+    output->setId(3);
+    output->setConnected(true);
+    QVERIFY(cache->restore(*output, hash.toLatin1()));
+    QCOMPARE(output->edid()->hash(), hash);
+    QVERIFY(!cache->restore(*output, QByteArrayLiteral("unknown")));
+
+    cache->clear();
+    QCOMPARE(cache->hits(), quint64(0));
+    QCOMPARE(cache->misses(), quint64(0));
+}
+
+void TestEdid::testEdidCacheBound()
+{
+    EdidCache *cache = EdidCache::instance();
+    cache->clear();
+
+    const auto docked = []() {
+        ConfigPtr config(new Config);
+        for (int id = 1; id <= 100; ++id) {
+            config->addOutput(configWithOutput(id, true)->output(id));
+        }
+        return config;
+    };
+
+    ConfigPtr config = docked();
+    QCOMPARE(cache->restore(config).size(), qsizetype(100));
+    const OutputList outputs = config->outputs();
+    for (const OutputPtr &output : outputs) {
+        cache->insert(*output, s_corEdid);
+    }
+    QCOMPARE(cache->size(), qsizetype(64));
+
+    // The least recently used ones went first
+    QList<int> evicted;
+    for (int id = 1; id <= 36; ++id) {
+        evicted << id;
+    }
+    QCOMPARE(cache->restore(docked()), evicted);
+
+    cache->clear();
+}
+
+void TestEdid::testEdidCacheSwap()
+{
+    EdidCache *cache = EdidCache::instance();
+    cache->clear();
+
+    ConfigPtr config = configWithOutput(1, true);
+    QCOMPARE(cache->restore(config), QList<int>({1}));
+    cache->insert(*config->output(1), s_corEdid);
+    const QString corHash = config->output(1)->edid()->hash();
+
+    // Another monitor on DP-1, the cache never saw it disconnected. The binary
+    // config carries a hash the cache doesn't know, so it must be fetched.
+    ConfigPtr swapped = configWithOutput(1, true);
+    swapped->output(1)->setEdid(s_dellEdid);
+    const QString dellHash = swapped->output(1)->edid()->hash();
+    QVERIFY(dellHash != corHash);
+    config = ConfigSerializer::deserializeConfigBinary(ConfigSerializer::serializeConfigBinary(swapped, 1));
+    QVERIFY(config);
+    QVERIFY(!config->output(1)->edid());
+    QCOMPARE(cache->restore(config), QList<int>({1}));
+    cache->insert(*config->output(1), s_dellEdid);
+    QCOMPARE(config->output(1)->edid()->hash(), dellHash);
+
+    // Deltas send the swapped output in full, with its hash
+    ConfigPtr base = configWithOutput(1, true);
+    base->output(1)->setEdid(s_corEdid);
+    const QByteArray delta = ConfigSerializer::serializeConfigDelta(base, swapped);
+    QVERIFY(!delta.isEmpty());
+    config = base->clone();
+    QVERIFY(ConfigSerializer::applyConfigDelta(config, delta));
+    QCOMPARE(config->output(1)->edid()->hash(), dellHash);
+
+    // Maps carry no hash. Swapped back in a change that was never decoded,
+    // so the connection generation is no use anymore.
+    cache->forgetConnections();
+    config = configWithOutput(1, true);
+    QCOMPARE(cache->restore(config), QList<int>({1}));
+    QVERIFY(!config->output(1)->edid());
+    cache->insert(*config->output(1), s_corEdid);
+    QCOMPARE(config->output(1)->edid()->hash(), corHash);
+
+    cache->clear();
+}
+
 QTEST_GUILESS_MAIN(TestEdid)
 
 #include "testedid.moc"
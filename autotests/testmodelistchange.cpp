@@ -16,6 +16,18 @@
 
 using namespace KScreen;
 
+// A connected and enabled output, showing @p currentModeId
+static OutputPtr createOutput(int id, const QList<ModeInfo> &modes, const QString &currentModeId)
+{
+    OutputPtr output(new Output);
+    output->setId(id);
+    output->setConnected(true);
+    output->setEnabled(true);
+    output->setModeInfos(modes);
+    output->setCurrentModeId(currentModeId);
+    return output;
+}
+
 class TestModeListChange : public QObject
 {
     Q_OBJECT
@@ -37,6 +49,11 @@ private Q_SLOTS:
     void cleanupTestCase();
 
     void modeListChange();
+    void cloneIsIndependent();
+    void modeInfos();
+    void applyKeepsModes();
+    void applyReportsChanges();
+    void benchmarkApplyUnchanged();
 };
 
 ConfigPtr TestModeListChange::getConfig()
@@ -157,6 +174,187 @@ void TestModeListChange::modeListChange()
     QCOMPARE(outputChangedSpy.count(), modesChangedSpy.count());
 }
 
+void TestModeListChange::cloneIsIndependent()
+{
+    const OutputPtr output(new Output);
+    output->setId(1);
+    output->setName(QStringLiteral("DP-1"));
+    output->setPos(QPoint(0, 0));
+    output->setModes(createModeList());
+    output->setCurrentModeId(QStringLiteral("11"));
+
+    // Changing the clone leaves the original alone...
+    const OutputPtr clone = output->clone();
+    QCOMPARE(clone->name(), output->name());
+    QCOMPARE(clone->modes().count(), output->modes().count());
+    QVERIFY(clone->mode(QStringLiteral("11")) != output->mode(QStringLiteral("11")));
+    clone->setPos(QPoint(1920, 0));
+    clone->mode(QStringLiteral("11"))->setSize(snew);
+    QCOMPARE(output->pos(), QPoint(0, 0));
+    QCOMPARE(output->mode(QStringLiteral("11"))->size(), s0);
+    QCOMPARE(clone->pos(), QPoint(1920, 0));
+    QCOMPARE(clone->mode(QStringLiteral("11"))->size(), snew);
+
+    // ... and the other way round
+    const OutputPtr clone2 = output->clone();
+    output->setName(QStringLiteral("DP-2"));
+    output->mode(QStringLiteral("22"))->setRefreshRate(30);
+    QCOMPARE(clone2->name(), QStringLiteral("DP-1"));
+    QCOMPARE(clone2->mode(QStringLiteral("22"))->refreshRate(), 60.0f);
+    QCOMPARE(clone->name(), QStringLiteral("DP-1"));
+}
+
+void TestModeListChange::modeInfos()
+{
+    const OutputPtr output(new Output);
+    QSignalSpy modesChangedSpy(output.data(), &Output::modesChanged);
+    QVERIFY(modesChangedSpy.isValid());
+
+    // Sorted by id, the last mode with a given id wins
+    output->setModeInfos({
+        ModeInfo{QStringLiteral("33"), QStringLiteral("33"), s2, 60},
+        ModeInfo{QStringLiteral("11"), QStringLiteral("old"), s3, 50},
+        ModeInfo{QStringLiteral("22"), QStringLiteral("22"), s1, 60},
+        ModeInfo{QStringLiteral("11"), QStringLiteral("11"), s0, 60},
+    });
+    QCOMPARE(modesChangedSpy.count(), 1);
+    const QList<ModeInfo> infos = output->modeInfos();
+    QCOMPARE(infos.count(), 3);
+    QCOMPARE(infos[0].id, QStringLiteral("11"));
+    QCOMPARE(infos[0].size, s0);
+    QCOMPARE(infos[1].id, QStringLiteral("22"));
+    QCOMPARE(infos[2].id, QStringLiteral("33"));
+    QCOMPARE(output->modeInfo(QStringLiteral("22")).size, s1);
+    QVERIFY(!output->modeInfo(QStringLiteral("44")).isValid());
+
+    // Mode objects match the values and stay the same once created
+    output->setModeInfos(infos);
+    QCOMPARE(modesChangedSpy.count(), 1);
+    const ModeList modes = output->modes();
+    QCOMPARE(modes.count(), 3);
+    QCOMPARE(modes.value(QStringLiteral("11"))->size(), s0);
+    QCOMPARE(modes.value(QStringLiteral("33"))->name(), QStringLiteral("33"));
+    QVERIFY(output->mode(QStringLiteral("11")) == modes.value(QStringLiteral("11")));
+    QVERIFY(!output->currentMode());
+
+    // Changes made through them are seen by the values and by clones
+    output->mode(QStringLiteral("22"))->setSize(snew);
+    QCOMPARE(output->modeInfo(QStringLiteral("22")).size, snew);
+    QCOMPARE(output->modeInfos()[1].size, snew);
+    const OutputPtr clone = output->clone();
+    QCOMPARE(clone->modeInfo(QStringLiteral("22")).size, snew);
+    QCOMPARE(clone->mode(QStringLiteral("22"))->size(), snew);
+    QVERIFY(clone->mode(QStringLiteral("22")) != output->mode(QStringLiteral("22")));
+}
+
+void TestModeListChange::applyKeepsModes()
+{
+    const OutputPtr output(new Output);
+    output->setModes(createModeList());
+    const ModeList before = output->modes();
+
+    QSignalSpy modesChangedSpy(output.data(), &Output::modesChanged);
+    QVERIFY(modesChangedSpy.isValid());
+
+    // Unchanged: nothing happens
+    OutputPtr other = output->clone();
+    output->apply(other);
+    QCOMPARE(modesChangedSpy.count(), 0);
+    QVERIFY(output->modes() == before);
+
+    // One mode changed, one removed, one added: the others are kept
+    QList<ModeInfo> modes = other->modeInfos();
+    modes[1].size = snew;
+    modes.removeLast();
+    modes << ModeInfo{idnew, idnew, s3, 60};
+    other->setModeInfos(modes);
+    output->apply(other);
+    QCOMPARE(modesChangedSpy.count(), 1);
+    const ModeList after = output->modes();
+    QCOMPARE(after.count(), 3);
+    QVERIFY(after.value(QStringLiteral("11")) == before.value(QStringLiteral("11")));
+    QVERIFY(after.value(QStringLiteral("22")) != before.value(QStringLiteral("22")));
+    QCOMPARE(after.value(QStringLiteral("22"))->size(), snew);
+    QVERIFY(!after.contains(QStringLiteral("33")));
+    QCOMPARE(after.value(idnew)->size(), s3);
+}
+
+void TestModeListChange::applyReportsChanges()
+{
+    QList<ModeInfo> modes;
+    const ModeList modeList = createModeList();
+    for (const ModePtr &mode : modeList) {
+        modes << mode->info();
+    }
+    ConfigPtr config(new Config);
+    for (int id = 1; id <= 2; ++id) {
+        config->addOutput(createOutput(id, modes, QStringLiteral("11")));
+    }
+
+    const ConfigPtr watched = config->clone();
+    QVERIFY(watched->apply(config->clone()).isEmpty());
+
+    // Only HDR changed: geometry listeners can skip this
+    config->output(1)->setHdrEnabled(true);
+    ConfigChanges changes = watched->apply(config->clone());
+    QVERIFY(!changes.isEmpty());
+    QVERIFY(!changes.configChanged);
+    QCOMPARE(changes.changedOutputs.count(), 1);
+    QCOMPARE(changes.outputChanges(1), Output::Changes(Output::Change::Hdr));
+    QCOMPARE(changes.outputChanges(2), Output::Changes(Output::Change::None));
+    QVERIFY(changes.affects(Output::Change::Color));
+    QVERIFY(!changes.affects(Output::Change::Geometry));
+
+    config->output(2)->setPos(QPoint(1920, 0));
+    config->output(2)->setVrrPolicy(Output::VrrPolicy::Never);
+    changes = watched->apply(config->clone());
+    QCOMPARE(changes.outputChanges(2), Output::Change::Position | Output::Change::VrrPolicy);
+    QVERIFY(changes.affects(Output::Change::Geometry));
+
+    // Added and removed outputs always affect the layout
+    config->removeOutput(1);
+    OutputPtr added(new Output);
+    added->setId(3);
+    config->addOutput(added);
+    changes = watched->apply(config->clone());
+    QCOMPARE(changes.removedOutputs, QList<int>{1});
+    QCOMPARE(changes.addedOutputs, QList<int>{3});
+    QVERIFY(changes.changedOutputs.isEmpty());
+    QVERIFY(changes.affects(Output::Change::Geometry));
+}
+
+void TestModeListChange::benchmarkApplyUnchanged()
+{
+    ConfigPtr config(new Config);
+    for (int id = 1; id <= 6; ++id) {
+        QList<ModeInfo> modes;
+        for (int i = 0; i < 150; ++i) {
+            modes << ModeInfo{QString::number(i), QStringLiteral("%1x%2").arg(640 + i * 8).arg(480 + i * 4), QSize(640 + i * 8, 480 + i * 4), 60};
+        }
+        config->addOutput(createOutput(id, modes, QStringLiteral("0")));
+    }
+
+    // A client that looked at the modes, updated with what the backend reports
+    const ConfigPtr watched = config->clone();
+    for (const OutputPtr &output : watched->outputs()) {
+        output->modes();
+    }
+    const ConfigPtr update = config->clone();
+
+    QSignalSpy modesChangedSpy(watched->output(1).data(), &Output::modesChanged);
+    QVERIFY(modesChangedSpy.isValid());
+    const ModePtr mode = watched->output(1)->mode(QStringLiteral("0"));
+
+    QBENCHMARK {
+        for (int i = 0; i < 10000; ++i) {
+            watched->apply(update);
+        }
+    }
+
+    QCOMPARE(modesChangedSpy.count(), 0);
+    QVERIFY(watched->output(1)->mode(QStringLiteral("0")) == mode);
+}
+
 QTEST_MAIN(TestModeListChange)
 
 #include "testmodelistchange.moc"
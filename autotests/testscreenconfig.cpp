@@ -7,8 +7,13 @@
 #include <QObject>
 #include <QtTest>
 
+#include <thread>
+
 #include "../src/backendmanager_p.h"
 #include "../src/config.h"
+#include "../src/configserializer_p.h"
+#include "../src/configsnapshot.h"
+#include "../src/configvalidator_p.h"
 #include "../src/getconfigoperation.h"
 #include "../src/mode.h"
 #include "../src/output.h"
@@ -17,6 +22,23 @@
 
 using namespace KScreen;
 
+// Adds a connected and enabled output to @p config, showing a mode of @p size if valid
+static OutputPtr addOutput(const ConfigPtr &config, int id, const QSize &size = QSize(), const QPoint &pos = QPoint())
+{
+    OutputPtr output(new Output);
+    output->setId(id);
+    output->setConnected(true);
+    output->setEnabled(true);
+    output->setPriority(id);
+    if (size.isValid()) {
+        output->setModeInfos({ModeInfo{QStringLiteral("1"), QString(), size, 60}});
+        output->setCurrentModeId(QStringLiteral("1"));
+    }
+    output->setPos(pos);
+    config->addOutput(output);
+    return output;
+}
+
 class testScreenConfig : public QObject
 {
     Q_OBJECT
@@ -35,6 +57,16 @@ private Q_SLOTS:
     void testInvalidMode();
     void cleanupTestCase();
     void testOutputPositionNormalization();
+    void geometryQueries();
+    void fingerprint();
+    void batchedUpdate();
+    void configDiff();
+    void configValidation();
+    void autoLayout();
+    void benchmarkAutoLayout_data();
+    void benchmarkAutoLayout();
+    void configSnapshot();
+    void sharedApply();
 };
 
 ConfigPtr testScreenConfig::getConfig()
@@ -311,6 +343,458 @@ void testScreenConfig::testOutputPositionNormalization()
     QCOMPARE(right->pos(), QPoint());
 }
 
+void testScreenConfig::geometryQueries()
+{
+    const ConfigPtr config(new Config);
+    // 1 2
+    // 3
+    const OutputPtr first = addOutput(config, 1, QSize(1920, 1080), QPoint(0, 0));
+    const OutputPtr second = addOutput(config, 2, QSize(1280, 1024), QPoint(1920, 0));
+    const OutputPtr third = addOutput(config, 3, QSize(1920, 1080), QPoint(0, 1080));
+
+    QCOMPARE(config->boundingRect(), QRect(0, 0, 3200, 2160));
+    QVERIFY(!config->overlaps());
+    QVERIFY(config->outputAt(QPointF(10, 10)) == first);
+    QVERIFY(config->outputAt(QPointF(1919.5, 500)) == first);
+    QVERIFY(config->outputAt(QPointF(1920, 500)) == second);
+    QVERIFY(config->outputAt(QPointF(100, 1080)) == third);
+    QVERIFY(!config->outputAt(QPointF(2000, 1500)));
+
+    QCOMPARE(config->neighbours(1, Qt::RightEdge).keys(), QList<int>{2});
+    QCOMPARE(config->neighbours(1, Qt::BottomEdge).keys(), QList<int>{3});
+    QVERIFY(config->neighbours(1, Qt::LeftEdge).isEmpty());
+    QCOMPARE(config->neighbours(2, Qt::LeftEdge).keys(), QList<int>{1});
+    // 2 and 3 do not touch
+    QVERIFY(config->neighbours(2, Qt::BottomEdge).isEmpty());
+    QVERIFY(config->neighbours(42, Qt::TopEdge).isEmpty());
+
+    // The index follows changes of the outputs
+    second->setPos(QPoint(1000, 0));
+    QVERIFY(config->overlaps());
+    QVERIFY(config->outputAt(QPointF(1500, 500)) == first);
+    QCOMPARE(config->boundingRect(), QRect(0, 0, 2280, 2160));
+
+    second->setEnabled(false);
+    QVERIFY(!config->overlaps());
+    QVERIFY(!config->outputAt(QPointF(2000, 500)));
+
+    third->setRotation(Output::Left);
+    QCOMPARE(config->boundingRect(), QRect(0, 0, 1920, 3000));
+
+    // ... and changes that come without a signal
+    third->mode(QStringLiteral("1"))->setSize(QSize(1280, 720));
+    QCOMPARE(config->boundingRect(), QRect(0, 0, 1920, 2360));
+
+    third->setModeInfos({ModeInfo{QStringLiteral("1"), QString(), QSize(1280, 720), 60}, ModeInfo{QStringLiteral("2"), QString(), QSize(800, 600), 60}});
+    third->setCurrentModeId(QString());
+    QCOMPARE(config->boundingRect(), QRect(0, 0, 1920, 2360));
+    third->setPreferredModes({QStringLiteral("2")});
+    QCOMPARE(config->boundingRect(), QRect(0, 0, 1920, 1880));
+
+    config->removeOutput(1);
+    QVERIFY(!config->outputAt(QPointF(10, 10)));
+    QCOMPARE(config->boundingRect(), QRect(0, 1080, 600, 800));
+}
+
+void testScreenConfig::fingerprint()
+{
+    KScreen::BackendManager::instance()->setBackendArgs({{QStringLiteral("TEST_DATA"), TEST_DATA "multipleoutput.json"}});
+
+    const ConfigPtr config = getConfig();
+    QVERIFY(!config.isNull());
+    QCOMPARE(config->connectedOutputs().count(), 2);
+    const OutputPtr output = config->connectedOutputs().first();
+
+    const quint64 identity = config->fingerprint();
+    const quint64 state = config->fingerprint(Output::FingerprintScope::State);
+    QVERIFY(identity != state);
+    QCOMPARE(config->clone()->fingerprint(), identity);
+    QCOMPARE(config->clone()->fingerprint(Output::FingerprintScope::State), state);
+
+    // Configurable properties only change the state
+    const quint64 outputIdentity = output->fingerprint();
+    output->setHdrEnabled(!output->isHdrEnabled());
+    QCOMPARE(output->fingerprint(), outputIdentity);
+    QCOMPARE(config->fingerprint(), identity);
+    QVERIFY(config->fingerprint(Output::FingerprintScope::State) != state);
+    output->setHdrEnabled(!output->isHdrEnabled());
+    QCOMPARE(config->fingerprint(Output::FingerprintScope::State), state);
+
+    // The ids and order of the outputs don't matter
+    const ConfigPtr reordered(new Config);
+    int id = 100;
+    for (const OutputPtr &connected : config->connectedOutputs()) {
+        const OutputPtr clone = connected->clone();
+        clone->setId(id--);
+        reordered->addOutput(clone);
+    }
+    QCOMPARE(reordered->fingerprint(), identity);
+
+    // Without an EDID the name identifies the output
+    output->setName(output->name() + QLatin1String("-renamed"));
+    QVERIFY(output->fingerprint() != outputIdentity);
+    QVERIFY(config->fingerprint() != identity);
+
+    // Disconnected outputs are left out
+    output->setConnected(false);
+    const ConfigPtr single(new Config);
+    single->addOutput(config->connectedOutputs().first()->clone());
+    QCOMPARE(config->fingerprint(), single->fingerprint());
+}
+
+void testScreenConfig::batchedUpdate()
+{
+    const ConfigPtr config(new Config);
+    for (int id = 1; id <= 3; ++id) {
+        addOutput(config, id)->setName(QStringLiteral("DP-%1").arg(id));
+    }
+    const OutputPtr first = config->output(1);
+    const OutputPtr third = config->output(3);
+
+    QSignalSpy prioritiesSpy(config.data(), &Config::prioritiesChanged);
+    QSignalSpy posSpy(first.data(), &Output::posChanged);
+    QSignalSpy hdrSpy(first.data(), &Output::hdrEnabledChanged);
+    QSignalSpy prioritySpy(third.data(), &Output::priorityChanged);
+
+    {
+        ConfigUpdateGuard guard(config);
+        first->setPos(QPoint(100, 0));
+        first->setPos(QPoint(200, 0));
+        // Changed and back again: nothing to report
+        first->setHdrEnabled(true);
+        first->setHdrEnabled(false);
+        config->setOutputPriority(third, 2);
+        config->setOutputPriority(third, 1);
+
+        // Nested updates only commit at the outermost end
+        config->beginUpdate();
+        first->setPos(QPoint(300, 0));
+        config->endUpdate();
+
+        QCOMPARE(posSpy.count(), 0);
+        QCOMPARE(prioritySpy.count(), 0);
+        QCOMPARE(prioritiesSpy.count(), 0);
+        // Not normalized yet
+        QCOMPARE(first->priority(), 1u);
+        QCOMPARE(third->priority(), 1u);
+    }
+
+    QCOMPARE(posSpy.count(), 1);
+    QCOMPARE(first->pos(), QPoint(300, 0));
+    QCOMPARE(hdrSpy.count(), 0);
+    QCOMPARE(prioritiesSpy.count(), 1);
+    QCOMPARE(prioritySpy.count(), 1);
+    QCOMPARE(third->priority(), 1u);
+    QCOMPARE(first->priority(), 2u);
+    QCOMPARE(config->output(2)->priority(), 3u);
+
+    // Outside of an update signals are emitted right away again
+    first->setPos(QPoint(0, 0));
+    QCOMPARE(posSpy.count(), 2);
+}
+
+void testScreenConfig::configDiff()
+{
+    KScreen::BackendManager::instance()->setBackendArgs({{QStringLiteral("TEST_DATA"), TEST_DATA "multipleoutput.json"}});
+
+    const ConfigPtr base = getConfig();
+    QVERIFY(!base.isNull());
+    const ConfigPtr config = base->clone();
+    QVERIFY(config->diff(base).isEmpty());
+
+    // Only the touched output and property show up
+    const OutputPtr output = config->outputs().first();
+    const qreal scale = output->scale();
+    output->setScale(scale + 1);
+    ConfigChanges changes = config->diff(base);
+    QVERIFY(!changes.configChanged);
+    QVERIFY(changes.addedOutputs.isEmpty());
+    QVERIFY(changes.removedOutputs.isEmpty());
+    QCOMPARE(changes.changedOutputs.keys(), QList<int>{output->id()});
+    QCOMPARE(changes.outputChanges(output->id()), Output::Changes(Output::Change::Scale));
+    // Diffing leaves both configs alone
+    QCOMPARE(base->output(output->id())->scale(), scale);
+
+    // Diffing predicts what applying does
+    const ConfigPtr applied = base->clone();
+    const ConfigChanges appliedChanges = applied->apply(config);
+    QCOMPARE(appliedChanges.changedOutputs, changes.changedOutputs);
+    QVERIFY(config->diff(applied).isEmpty());
+
+    // The delta sent for it only carries the scale of that output
+    const QByteArray delta = ConfigSerializer::serializeConfigDelta(base, config);
+    QVERIFY(!delta.isEmpty());
+    QVERIFY(delta.size() < ConfigSerializer::serializeConfigBinary(config).size() / 4);
+    const ConfigPtr patched = base->clone();
+    QVERIFY(ConfigSerializer::applyConfigDelta(patched, delta));
+    QVERIFY(patched->diff(config).isEmpty());
+
+    // Config-wide properties are reported and taken over too
+    config->setSupportedFeatures(base->supportedFeatures() ^ Config::Feature::TabletMode);
+    QVERIFY(config->diff(base).configChanged);
+    QVERIFY(applied->apply(config).configChanged);
+    QCOMPARE(applied->supportedFeatures(), config->supportedFeatures());
+
+    const int removedId = config->outputs().last()->id();
+    config->removeOutput(removedId);
+    changes = config->diff(base);
+    QCOMPARE(changes.removedOutputs, QList<int>{removedId});
+    QVERIFY(base->diff(config).addedOutputs == QList<int>{removedId});
+}
+
+void testScreenConfig::configValidation()
+{
+    KScreen::BackendManager::instance()->setBackendArgs({{QStringLiteral("TEST_DATA"), TEST_DATA "singleoutput.json"}});
+
+    const ConfigPtr config = getConfig();
+    QVERIFY(!config.isNull());
+    ConfigValidator::instance()->clear();
+
+    QVERIFY(Config::validate(config).isValid());
+    QCOMPARE(ConfigValidator::instance()->cacheHits(), quint64(0));
+    QVERIFY(Config::validate(config).isValid());
+    QCOMPARE(ConfigValidator::instance()->cacheHits(), quint64(1));
+
+    const OutputPtr output = config->outputs().first();
+    const QString modeId = output->currentModeId();
+    output->setCurrentModeId(QStringLiteral("42"));
+    ConfigValidation validation = Config::validate(config);
+    QCOMPARE(validation.reason, ConfigValidation::Reason::UnknownMode);
+    QCOMPARE(validation.outputId, output->id());
+    QVERIFY(!Config::canBeApplied(config));
+
+    // Back to a layout checked before
+    output->setCurrentModeId(modeId);
+    const quint64 hits = ConfigValidator::instance()->cacheHits();
+    QVERIFY(Config::validate(config).isValid());
+    QCOMPARE(ConfigValidator::instance()->cacheHits(), hits + 1);
+
+    output->setPos(QPoint(config->screen()->maxSize().width(), 0));
+    validation = Config::validate(config);
+    QCOMPARE(validation.reason, ConfigValidation::Reason::TooWide);
+    QCOMPARE(validation.outputId, 0);
+    output->setPos(QPoint(0, 0));
+
+    // Modes changed through the Mode objects are taken into account as well
+    output->currentMode()->setSize(config->screen()->maxSize() + QSize(1, 0));
+    QCOMPARE(Config::validate(config).reason, ConfigValidation::Reason::TooWide);
+
+    output->setEnabled(false);
+    QCOMPARE(Config::validate(config, Config::ValidityFlag::RequireAtLeastOneEnabledScreen).reason, ConfigValidation::Reason::NoEnabledOutput);
+    QVERIFY(Config::validate(config).isValid());
+
+    QCOMPARE(Config::validate(ConfigPtr()).reason, ConfigValidation::Reason::NoConfig);
+}
+
+void testScreenConfig::autoLayout()
+{
+    const ConfigPtr config(new Config);
+    config->setSupportedFeatures(Config::Feature::PerOutputScaling);
+    const OutputPtr first = addOutput(config, 1, QSize(1920, 1080), QPoint(0, 0));
+    const OutputPtr second = addOutput(config, 2, QSize(2560, 1440), QPoint(2500, 0));
+    second->setScale(2.0);
+    // Just connected, on top of the first one
+    const OutputPtr third = addOutput(config, 3, QSize(1280, 1024), QPoint(0, 0));
+    const OutputPtr disabled = addOutput(config, 4, QSize(1920, 1080), QPoint(5000, 5000));
+    disabled->setEnabled(false);
+    QVERIFY(config->overlaps());
+
+    QVERIFY(config->autoLayout());
+    QCOMPARE(first->pos(), QPoint(0, 0));
+    QCOMPARE(third->pos(), QPoint(1920, 0));
+    QCOMPARE(second->pos(), QPoint(3200, 0));
+    QCOMPARE(disabled->pos(), QPoint(5000, 5000));
+    QVERIFY(!config->overlaps());
+    QCOMPARE(config->boundingRect(), QRect(0, 0, 4480, 1080));
+    QVERIFY(!config->autoLayout());
+
+    // Outputs next to each other are columns of their own
+    QVERIFY(!config->autoLayout(Config::LayoutPolicy::Columns));
+
+    third->setPos(QPoint(200, 1500));
+    second->setPos(QPoint(1920, 2000));
+    QVERIFY(config->autoLayout(Config::LayoutPolicy::Columns));
+    QCOMPARE(first->pos(), QPoint(0, 0));
+    QCOMPARE(third->pos(), QPoint(0, 1080));
+    QCOMPARE(second->pos(), QPoint(1920, 0));
+    QVERIFY(!config->autoLayout(Config::LayoutPolicy::Columns));
+    QVERIFY(!config->autoLayout(Config::LayoutPolicy::Rows));
+
+    // Gaps between rows are closed, the rows keep their order
+    third->setPos(QPoint(300, 3000));
+    second->setPos(QPoint(2000, 100));
+    QVERIFY(config->autoLayout());
+    QCOMPARE(first->pos(), QPoint(0, 0));
+    QCOMPARE(second->pos(), QPoint(1920, 0));
+    QCOMPARE(third->pos(), QPoint(0, 1080));
+    QVERIFY(!config->overlaps());
+}
+
+static ConfigPtr createVideoWall(int outputCount)
+{
+    const ConfigPtr config(new Config);
+    for (int id = 1; id <= outputCount; ++id) {
+        addOutput(config, id, QSize(1920, 1080));
+    }
+    return config;
+}
+
+void testScreenConfig::benchmarkAutoLayout_data()
+{
+    QTest::addColumn<int>("outputCount");
+
+    QTest::newRow("8 outputs") << 8;
+    QTest::newRow("32 outputs") << 32;
+    QTest::newRow("128 outputs") << 128;
+}
+
+void testScreenConfig::benchmarkAutoLayout()
+{
+    QFETCH(int, outputCount);
+
+    const ConfigPtr config = createVideoWall(outputCount);
+    const OutputList outputs = config->outputs();
+    // Roughly a grid, with outputs overlapping and leaving gaps as after a hotplug
+    const auto scramble = [&outputs]() {
+        for (const OutputPtr &output : outputs) {
+            const int id = output->id();
+            output->setPos(QPoint((id * 7919) % 8 * 1700, (id * 104729) % 4 * 1300));
+        }
+    };
+
+    QBENCHMARK {
+        scramble();
+        config->autoLayout();
+    }
+    QVERIFY(!config->overlaps());
+}
+
+void testScreenConfig::configSnapshot()
+{
+    KScreen::BackendManager::instance()->setBackendArgs({{QStringLiteral("TEST_DATA"), TEST_DATA "multipleoutput.json"}});
+
+    const ConfigPtr config = getConfig();
+    QVERIFY(!config.isNull());
+    QVERIFY(ConfigSnapshot().isNull());
+
+    const ConfigSnapshot snapshot = config->snapshot();
+    QVERIFY(!snapshot.isNull());
+    QCOMPARE(snapshot.outputs().count(), config->outputs().count());
+    QCOMPARE(snapshot.fingerprint(Output::FingerprintScope::Identity), config->fingerprint(Output::FingerprintScope::Identity));
+    QCOMPARE(snapshot.fingerprint(Output::FingerprintScope::State), config->fingerprint(Output::FingerprintScope::State));
+    QCOMPARE(snapshot.screen(), config->screen()->info());
+    QCOMPARE(snapshot.supportedFeatures(), config->supportedFeatures());
+    QCOMPARE(snapshot.primaryOutput().id(), config->primaryOutput()->id());
+    for (const OutputPtr &output : config->outputs()) {
+        const OutputSnapshot outputSnapshot = snapshot.output(output->id());
+        QCOMPARE(outputSnapshot.name(), output->name());
+        QCOMPARE(outputSnapshot.hash(), output->hash());
+        QCOMPARE(outputSnapshot.modeInfos(), output->modeInfos());
+        QCOMPARE(outputSnapshot.preferredModeId(), output->preferredModeId());
+        QCOMPARE(outputSnapshot.fingerprint(Output::FingerprintScope::State), output->fingerprint(Output::FingerprintScope::State));
+        QCOMPARE(snapshot.outputGeometryForOutput(outputSnapshot), config->outputGeometryForOutput(*output));
+    }
+    QVERIFY(snapshot.output(42).isNull());
+
+    // Later changes of the config do not reach the snapshot
+    const OutputPtr output = config->output(1);
+    const QPoint pos = output->pos();
+    const QSize modeSize = output->currentMode()->size();
+    output->setPos(QPoint(4000, 0));
+    output->currentMode()->setSize(QSize(640, 480));
+    QCOMPARE(snapshot.output(1).pos(), pos);
+    QCOMPARE(snapshot.output(1).modeInfo(output->currentModeId()).size, modeSize);
+
+    // ... but are part of the next one, including those made through the Mode objects
+    const ConfigSnapshot changed = config->snapshot();
+    QCOMPARE(changed.output(1).pos(), QPoint(4000, 0));
+    QCOMPARE(changed.output(1).enforcedModeSize(), QSize(640, 480));
+    QVERIFY(changed.fingerprint(Output::FingerprintScope::State) != snapshot.fingerprint(Output::FingerprintScope::State));
+
+    // Snapshots can be read and dropped on other threads
+    quint64 fingerprint = 0;
+    quint64 configFingerprint = 0;
+    QRect geometry;
+    std::thread worker([snapshot, &fingerprint, &configFingerprint, &geometry]() {
+        fingerprint = snapshot.fingerprint(Output::FingerprintScope::State);
+        geometry = snapshot.outputGeometryForOutput(snapshot.output(1));
+        configFingerprint = snapshot.toConfig()->fingerprint(Output::FingerprintScope::State);
+    });
+    worker.join();
+    QCOMPARE(fingerprint, snapshot.fingerprint(Output::FingerprintScope::State));
+    QCOMPARE(configFingerprint, fingerprint);
+    QCOMPARE(geometry.topLeft(), pos);
+
+    // Back to a config, which can be changed independently
+    const ConfigPtr restored = snapshot.toConfig();
+    QVERIFY(restored);
+    QCOMPARE(restored->fingerprint(Output::FingerprintScope::State), snapshot.fingerprint(Output::FingerprintScope::State));
+    QCOMPARE(restored->outputs().keys(), config->outputs().keys());
+    QCOMPARE(bool(restored->output(1)->edid()), bool(config->output(1)->edid()));
+    QCOMPARE(restored->output(1)->pos(), pos);
+    restored->output(1)->setPos(QPoint(0, 500));
+    QCOMPARE(snapshot.output(1).pos(), pos);
+    QCOMPARE(snapshot.toConfig()->output(1)->pos(), pos);
+}
+
+void testScreenConfig::sharedApply()
+{
+    KScreen::BackendManager::instance()->setBackendArgs({{QStringLiteral("TEST_DATA"), TEST_DATA "multipleoutput.json"}});
+
+    const ConfigPtr base = getConfig();
+    QVERIFY(!base.isNull());
+
+    // Several watchers of the same config, one of them changed it locally
+    QList<ConfigPtr> configs;
+    for (int i = 0; i < 4; ++i) {
+        configs << base->clone();
+    }
+    configs.last()->output(1)->setRotation(Output::Left);
+
+    const ConfigPtr target = base->clone();
+    target->output(1)->setPos(QPoint(0, 500));
+    target->output(2)->setScale(2.0);
+
+    QSignalSpy leaderPosSpy(configs.at(0)->output(1).data(), &Output::posChanged);
+    QSignalSpy followerPosSpy(configs.at(1)->output(1).data(), &Output::posChanged);
+    QSignalSpy followerScaleSpy(configs.at(2)->output(2).data(), &Output::scaleChanged);
+    QSignalSpy followerRotationSpy(configs.at(2)->output(1).data(), &Output::rotationChanged);
+
+    const QList<ConfigChanges> changes = Config::apply(configs, target);
+    QCOMPARE(changes.count(), configs.count());
+    for (const ConfigPtr &config : std::as_const(configs)) {
+        QVERIFY(config->diff(target).isEmpty());
+        QCOMPARE(config->outputGeometryForOutput(*config->output(2)), target->outputGeometryForOutput(*target->output(2)));
+    }
+    QCOMPARE(changes.at(0).outputChanges(1), Output::Changes(Output::Change::Position));
+    QCOMPARE(changes.at(0).outputChanges(2), Output::Changes(Output::Change::Scale));
+    QCOMPARE(changes.at(1).changedOutputs, changes.at(0).changedOutputs);
+    QCOMPARE(changes.at(2).changedOutputs, changes.at(0).changedOutputs);
+    QCOMPARE(changes.at(3).outputChanges(1), Output::Change::Position | Output::Change::Rotation);
+
+    QCOMPARE(leaderPosSpy.count(), 1);
+    QCOMPARE(followerPosSpy.count(), 1);
+    QCOMPARE(followerScaleSpy.count(), 1);
+    QCOMPARE(followerRotationSpy.count(), 0);
+
+    // Sharing the result doesn't tie the configs together
+    configs.at(1)->output(1)->setPos(QPoint(10, 10));
+    QCOMPARE(configs.at(0)->output(1)->pos(), QPoint(0, 500));
+    QCOMPARE(configs.at(2)->output(1)->pos(), QPoint(0, 500));
+
+    // The logical size the config derives from the state is announced by followers too
+    const ConfigPtr rotated = target->clone();
+    rotated->output(2)->setRotation(Output::Right);
+    QSignalSpy leaderSizeSpy(configs.at(0)->output(2).data(), &Output::explicitLogicalSizeChanged);
+    QSignalSpy followerSizeSpy(configs.at(2)->output(2).data(), &Output::explicitLogicalSizeChanged);
+    QSignalSpy unchangedSizeSpy(configs.at(2)->output(1).data(), &Output::explicitLogicalSizeChanged);
+    Config::apply(configs, rotated);
+    QCOMPARE(leaderSizeSpy.count(), 1);
+    QCOMPARE(followerSizeSpy.count(), 1);
+    QCOMPARE(unchangedSizeSpy.count(), 0);
+    QCOMPARE(configs.at(2)->output(2)->explicitLogicalSize(), rotated->logicalSizeForOutput(*rotated->output(2)));
+}
+
 QTEST_MAIN(testScreenConfig)
 
 #include "testscreenconfig.moc"
@@ -13,6 +13,7 @@
 
 #include "kscreen_kwayland_logging.h"
 
+#include <config.h>
 #include <configmonitor.h>
 #include <mode.h>
 #include <output.h>
@@ -80,6 +81,16 @@ ConfigPtr WaylandBackend::config() const
 }
 
 void WaylandBackend::setConfig(const KScreen::ConfigPtr &newconfig)
+{
+    applyConfig(newconfig, nullptr);
+}
+
+void WaylandBackend::applyConfigChanges(const KScreen::ConfigPtr &newconfig, const KScreen::ConfigChanges &changes)
+{
+    applyConfig(newconfig, &changes);
+}
+
+void WaylandBackend::applyConfig(const KScreen::ConfigPtr &newconfig, const KScreen::ConfigChanges *changes)
 {
     if (!newconfig) {
         return;
@@ -88,7 +99,7 @@ void WaylandBackend::setConfig(const KScreen::ConfigPtr &newconfig)
     QEventLoop loop;
 
     connect(m_internalConfig, &WaylandConfig::configChanged, &loop, &QEventLoop::quit);
-    m_internalConfig->applyConfig(newconfig);
+    m_internalConfig->applyConfig(newconfig, changes);
 
     loop.exec();
 }
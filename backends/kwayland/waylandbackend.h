@@ -28,10 +28,13 @@ public:
     QString serviceName() const override;
     KScreen::ConfigPtr config() const override;
     void setConfig(const KScreen::ConfigPtr &config) override;
+    void applyConfigChanges(const KScreen::ConfigPtr &config, const KScreen::ConfigChanges &changes) override;
     bool isValid() const override;
     QByteArray edid(int outputId) const override;
 
 private:
+    void applyConfig(const KScreen::ConfigPtr &config, const KScreen::ConfigChanges *changes);
+
     WaylandConfig *m_internalConfig;
 };
 
@@ -18,6 +18,7 @@
 
 #include <QThread>
 #include <QTimer>
+#include <config.h>
 #include <configmonitor.h>
 #include <mode.h>
 #include <output.h>
@@ -305,7 +306,7 @@ WaylandOutputDevice *WaylandConfig::findOutputDevice(struct ::kde_output_device_
     return nullptr;
 }
 
-void WaylandConfig::applyConfig(const KScreen::ConfigPtr &newConfig)
+void WaylandConfig::applyConfig(const KScreen::ConfigPtr &newConfig, const KScreen::ConfigChanges *changes)
 {
     using namespace KWayland::Client;
 
@@ -316,13 +317,20 @@ void WaylandConfig::applyConfig(const KScreen::ConfigPtr &newConfig)
     bool changed = false;
 
     if (m_blockSignals) {
-        // Last apply still pending, remember new changes and apply afterwards
+        // Last apply still pending, remember new changes and apply afterwards.
+        // The changes are relative to a state the compositor is about to leave,
+        // so the pending config is compared in full.
         m_kscreenPendingConfig = newConfig;
         return;
     }
 
     for (const auto &output : newConfig->outputs()) {
-        changed |= m_outputMap[output->id()]->setWlConfig(wlConfig, output);
+        WaylandOutputDevice *device = m_outputMap[output->id()];
+        if (changes && !changes->addedOutputs.contains(output->id()) && !changes->changedOutputs.contains(output->id())) {
+            changed |= device->setWlPriority(wlConfig, output);
+            continue;
+        }
+        changed |= device->setWlConfig(wlConfig, output);
     }
 
     if (!changed) {
@@ -31,6 +31,7 @@ class OutputManagement;
 namespace KScreen
 {
 class Output;
+struct ConfigChanges;
 class WaylandOutputDevice;
 class WaylandScreen;
 class WaylandOutputManagement;
@@ -60,7 +61,8 @@ public:
     KScreen::ConfigPtr currentConfig();
     QMap<int, WaylandOutputDevice *> outputMap() const;
 
-    void applyConfig(const KScreen::ConfigPtr &newConfig);
+    // With @p changes, outputs which are not part of them only get their priority sent
+    void applyConfig(const KScreen::ConfigPtr &newConfig, const KScreen::ConfigChanges *changes = nullptr);
     WaylandOutputDevice *findOutputDevice(struct ::kde_output_device_v2 *outputdevice) const;
 
     bool isReady() const;
@@ -138,20 +138,21 @@ wl_output_transform toKWaylandTransform(const Output::Rotation rotation)
 
 void KScreen::WaylandOutputDevice::updateKScreenModes(OutputPtr &output)
 {
-    ModeList modeList;
+    QList<ModeInfo> modeList;
+    modeList.reserve(m_modes.count());
     QStringList preferredModeIds;
     QString currentModeId = QStringLiteral("-1");
     int modeId = 0;
 
     for (const WaylandOutputDeviceMode *wlMode : std::as_const(m_modes)) {
-        ModePtr mode(new Mode());
+        ModeInfo mode;
 
         const QString modeIdStr = QString::number(modeId);
         // KWayland gives the refresh rate as int in mHz
-        mode->setId(modeIdStr);
-        mode->setRefreshRate(wlMode->refreshRate() / 1000.0);
-        mode->setSize(wlMode->size());
-        mode->setName(modeName(wlMode));
+        mode.id = modeIdStr;
+        mode.refreshRate = wlMode->refreshRate() / 1000.0;
+        mode.size = wlMode->size();
+        mode.name = modeName(wlMode);
 
         if (m_mode == wlMode) {
             currentModeId = modeIdStr;
@@ -162,12 +163,12 @@ void KScreen::WaylandOutputDevice::updateKScreenModes(OutputPtr &output)
         }
 
         // Add to the modelist which gets set on the output
-        modeList[modeIdStr] = mode;
+        modeList << mode;
         modeId++;
     }
     output->setCurrentModeId(currentModeId);
     output->setPreferredModes(preferredModeIds);
-    output->setModes(modeList);
+    output->setModeInfos(modeList);
 }
 
 void WaylandOutputDevice::updateKScreenOutput(OutputPtr &output)
@@ -264,13 +265,7 @@ bool WaylandOutputDevice::setWlConfig(WaylandOutputConfiguration *wlConfig, cons
         wlConfig->set_rgb_range(object(), static_cast<uint32_t>(output->rgbRange()));
         changed = true;
     }
-    if (output->priority() != m_index) {
-        changed = true;
-    }
-    // always send all outputs
-    if (kde_output_configuration_v2_get_version(wlConfig->object()) >= KDE_OUTPUT_CONFIGURATION_V2_SET_PRIORITY_SINCE_VERSION) {
-        wlConfig->set_priority(object(), output->priority());
-    }
+    changed |= setWlPriority(wlConfig, output);
     if ((output->capabilities() & Output::Capability::HighDynamicRange) && (m_hdrEnabled == 1) != output->isHdrEnabled()) {
         wlConfig->set_high_dynamic_range(object(), output->isHdrEnabled());
         changed = true;
@@ -287,6 +282,15 @@ bool WaylandOutputDevice::setWlConfig(WaylandOutputConfiguration *wlConfig, cons
     return changed;
 }
 
+bool WaylandOutputDevice::setWlPriority(WaylandOutputConfiguration *wlConfig, const KScreen::OutputPtr &output)
+{
+    // always send all outputs
+    if (kde_output_configuration_v2_get_version(wlConfig->object()) >= KDE_OUTPUT_CONFIGURATION_V2_SET_PRIORITY_SINCE_VERSION) {
+        wlConfig->set_priority(object(), output->priority());
+    }
+    return output->priority() != m_index;
+}
+
 QString WaylandOutputDevice::modeName(const WaylandOutputDeviceMode *m) const
 {
     return QString::number(m->size().width()) + QLatin1Char('x') + QString::number(m->size().height()) + QLatin1Char('@')
@@ -54,6 +54,8 @@ public:
     void setIndex(uint32_t priority);
     uint32_t index() const;
     bool setWlConfig(WaylandOutputConfiguration *wlConfig, const KScreen::OutputPtr &output);
+    // Only the priority, which has to be sent for every output
+    bool setWlPriority(WaylandOutputConfiguration *wlConfig, const KScreen::OutputPtr &output);
 
     QString modeId() const;
     QString uuid() const
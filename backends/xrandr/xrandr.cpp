@@ -12,11 +12,11 @@
 #include "../xcbeventlistener.h"
 #include "../xcbwrapper.h"
 
+#include "changecompressor_p.h"
 #include "types.h"
 
 #include <QRect>
 #include <QTime>
-#include <QTimer>
 
 #include <QtGui/private/qtx11extras_p.h>
 
@@ -90,10 +90,9 @@ XRandR::XRandR()
         connect(m_x11Helper, &XCBEventListener::crtcChanged, this, &XRandR::crtcChanged, Qt::QueuedConnection);
         connect(m_x11Helper, &XCBEventListener::screenChanged, this, &XRandR::screenChanged, Qt::QueuedConnection);
 
-        m_configChangeCompressor = new QTimer(this);
-        m_configChangeCompressor->setSingleShot(true);
-        m_configChangeCompressor->setInterval(500);
-        connect(m_configChangeCompressor, &QTimer::timeout, [&]() {
+        // A hotplug comes as a burst of output, crtc and screen events
+        m_configChangeCompressor = new KScreen::ChangeCompressor(QStringLiteral("xrandr"), 200, 1000, this);
+        connect(m_configChangeCompressor, &KScreen::ChangeCompressor::triggered, this, [this]() {
             qCDebug(KSCREEN_XRANDR) << "Emitting configChanged()";
             Q_EMIT configChanged(config());
         });
@@ -107,6 +106,13 @@ XRandR::~XRandR()
     delete m_x11Helper;
 }
 
+void XRandR::init(const QVariantMap &arguments)
+{
+    if (m_configChangeCompressor) {
+        m_configChangeCompressor->configure(arguments);
+    }
+}
+
 QString XRandR::name() const
 {
     return QStringLiteral("XRandR");
@@ -119,7 +125,7 @@ QString XRandR::serviceName() const
 
 void XRandR::outputChanged(xcb_randr_output_t output, xcb_randr_crtc_t crtc, xcb_randr_mode_t mode, xcb_randr_connection_t connection)
 {
-    m_configChangeCompressor->start();
+    m_configChangeCompressor->notify();
 
     XRandROutput *xOutput = s_internalConfig->output(output);
     if (!xOutput) {
@@ -153,7 +159,7 @@ void XRandR::crtcChanged(xcb_randr_crtc_t crtc, xcb_randr_mode_t mode, xcb_randr
     }
 
     xCrtc->updateConfigTimestamp(timestamp);
-    m_configChangeCompressor->start();
+    m_configChangeCompressor->notify();
 }
 
 void XRandR::screenChanged(xcb_randr_rotation_t rotation, const QSize &sizePx, const QSize &sizeMm)
@@ -169,7 +175,7 @@ void XRandR::screenChanged(xcb_randr_rotation_t rotation, const QSize &sizePx, c
     Q_ASSERT(xScreen);
     xScreen->update(newSizePx);
 
-    m_configChangeCompressor->start();
+    m_configChangeCompressor->notify();
 }
 
 ConfigPtr XRandR::config() const
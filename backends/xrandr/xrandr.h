@@ -15,7 +15,11 @@
 #include <xcb/xcb.h>
 
 class QRect;
-class QTimer;
+
+namespace KScreen
+{
+class ChangeCompressor;
+}
 
 class XCBEventListener;
 class XRandRConfig;
@@ -29,6 +33,7 @@ public:
     explicit XRandR();
     ~XRandR() override;
 
+    void init(const QVariantMap &arguments) override;
     QString name() const override;
     QString serviceName() const override;
     KScreen::ConfigPtr config() const override;
@@ -63,7 +68,7 @@ private:
     XCBEventListener *m_x11Helper;
     bool m_isValid;
 
-    QTimer *m_configChangeCompressor;
+    KScreen::ChangeCompressor *m_configChangeCompressor;
 };
 
 Q_DECLARE_LOGGING_CATEGORY(KSCREEN_XRANDR)
@@ -48,6 +48,11 @@ KScreen::ModePtr XRandRMode::toKScreenMode()
     return kscreenMode;
 }
 
+KScreen::ModeInfo XRandRMode::toModeInfo() const
+{
+    return KScreen::ModeInfo{QString::number(m_id), m_name, m_size, m_refreshRate};
+}
+
 xcb_randr_mode_t XRandRMode::id() const
 {
     return m_id;
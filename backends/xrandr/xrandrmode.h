@@ -33,6 +33,7 @@ public:
     ~XRandRMode() override;
 
     KScreen::ModePtr toKScreenMode();
+    KScreen::ModeInfo toModeInfo() const;
 
     xcb_randr_mode_t id() const;
     QSize size() const;
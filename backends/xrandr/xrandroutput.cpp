@@ -473,12 +473,12 @@ KScreen::OutputPtr XRandROutput::toKScreenOutput() const
 
     kscreenOutput->setConnected(isConnected());
     if (isConnected()) {
-        KScreen::ModeList kscreenModes;
+        QList<KScreen::ModeInfo> kscreenModes;
+        kscreenModes.reserve(m_modes.count());
         for (auto iter = m_modes.constBegin(), end = m_modes.constEnd(); iter != end; ++iter) {
-            XRandRMode *mode = iter.value();
-            kscreenModes.insert(QString::number(iter.key()), mode->toKScreenMode());
+            kscreenModes << iter.value()->toModeInfo();
         }
-        kscreenOutput->setModes(kscreenModes);
+        kscreenOutput->setModeInfos(kscreenModes);
         kscreenOutput->setPreferredModes(m_preferredModes);
         kscreenOutput->setClones([](const QList<xcb_randr_output_t> &clones) {
             QList<int> kclones;
@@ -5,6 +5,7 @@
  */
 
 #include "abstractbackend.h"
+#include "config.h"
 
 void KScreen::AbstractBackend::init(const QVariantMap &arguments)
 {
@@ -16,3 +17,9 @@ QByteArray KScreen::AbstractBackend::edid(int outputId) const
     Q_UNUSED(outputId);
     return QByteArray();
 }
+
+void KScreen::AbstractBackend::applyConfigChanges(const KScreen::ConfigPtr &config, const KScreen::ConfigChanges &changes)
+{
+    Q_UNUSED(changes);
+    setConfig(config);
+}
@@ -17,6 +17,7 @@
 namespace KScreen
 {
 class Config;
+struct ConfigChanges;
 
 /**
  * Abstract class for backends.
@@ -68,6 +69,19 @@ public:
      */
     virtual void setConfig(const KScreen::ConfigPtr &config) = 0;
 
+    /**
+     * Apply a config which differs from the backend's current one only by
+     * @p changes, see Config::diff().
+     *
+     * Backends can use this to leave untouched outputs alone. The default
+     * implementation calls setConfig().
+     *
+     * @param config Configuration to apply
+     * @param changes What @p config changes compared to the current configuration
+     * @since 6.0
+     */
+    virtual void applyConfigChanges(const KScreen::ConfigPtr &config, const KScreen::ConfigChanges &changes);
+
     /**
      * Returns whether the backend is in valid state.
      *
@@ -12,20 +12,29 @@
 #include "abstractbackend.h"
 #include "config.h"
 #include "configserializer_p.h"
+#include "edid.h"
+#include "output.h"
 
 #include <QDBusConnection>
 #include <QDBusError>
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDateTime>
 
-BackendDBusWrapper::BackendDBusWrapper(KScreen::AbstractBackend *backend)
+BackendDBusWrapper::BackendDBusWrapper(KScreen::AbstractBackend *backend, const QVariantMap &arguments)
     : QObject()
     , mBackend(backend)
+    // Backends that get bursts of events compress them already, keep the extra delay short
+    , mChangeCompressor(QStringLiteral("launcher"), 100, 500)
+    , mGeneration(QDateTime::currentMSecsSinceEpoch())
 {
+    qDBusRegisterMetaType<QMap<int, QByteArray>>();
+    KScreen::ConfigSerializer::registerDBusTypes();
+
     connect(mBackend, &KScreen::AbstractBackend::configChanged, this, &BackendDBusWrapper::backendConfigChanged);
 
-    mChangeCollector.setSingleShot(true);
-    mChangeCollector.setInterval(200); // wait for 200 msecs without any change
-                                       // before actually emitting configChanged
-    connect(&mChangeCollector, &QTimer::timeout, this, &BackendDBusWrapper::doEmitConfigChanged);
+    mChangeCompressor.configure(arguments);
+    connect(&mChangeCompressor, &KScreen::ChangeCompressor::triggered, this, &BackendDBusWrapper::doEmitConfigChanged);
 }
 
 BackendDBusWrapper::~BackendDBusWrapper()
@@ -45,18 +54,9 @@ bool BackendDBusWrapper::init()
     return true;
 }
 
-QVariantMap BackendDBusWrapper::getConfig() const
+QVariantMap BackendDBusWrapper::getConfig()
 {
-    const KScreen::ConfigPtr config = mBackend->config();
-    Q_ASSERT(!config.isNull());
-    if (!config) {
-        qCWarning(KSCREEN_BACKEND_LAUNCHER) << "Backend provided an empty config!";
-        return QVariantMap();
-    }
-
-    const QJsonObject obj = KScreen::ConfigSerializer::serializeConfig(mBackend->config());
-    Q_ASSERT(!obj.isEmpty());
-    return obj.toVariantMap();
+    return replyWithConfig();
 }
 
 QVariantMap BackendDBusWrapper::setConfig(const QVariantMap &configMap)
@@ -70,12 +70,48 @@ QVariantMap BackendDBusWrapper::setConfig(const QVariantMap &configMap)
     mBackend->setConfig(config);
 
     mCurrentConfig = mBackend->config();
+    invalidateSerializedConfig();
     QMetaObject::invokeMethod(this, "doEmitConfigChanged", Qt::QueuedConnection);
 
     // TODO: setConfig should return adjusted config that was actually applied
-    const QJsonObject obj = KScreen::ConfigSerializer::serializeConfig(mCurrentConfig);
-    Q_ASSERT(!obj.isEmpty());
-    return obj.toVariantMap();
+    return replyWithConfig();
+}
+
+QVariantMap BackendDBusWrapper::replyWithConfig()
+{
+    if (!calledFromDBus()) {
+        const KScreen::ConfigPtr config = currentConfig();
+        return config ? KScreen::ConfigSerializer::serializeConfig(config).toVariantMap() : QVariantMap();
+    }
+
+    const QVariant config = marshalledConfig();
+    if (!config.isValid()) {
+        sendErrorReply(QDBusError::Failed, QStringLiteral("Backend provided no config"));
+        return QVariantMap();
+    }
+    // Copy the marshalled config into the reply instead of building the map first
+    setDelayedReply(true);
+    connection().send(message().createReply(config));
+    return QVariantMap();
+}
+
+QVariant BackendDBusWrapper::marshalledConfig()
+{
+    if (mMarshalledConfig.isValid()) {
+        ++mConfigCacheHits;
+        return mMarshalledConfig;
+    }
+
+    const KScreen::ConfigPtr config = currentConfig();
+    Q_ASSERT(!config.isNull());
+    if (!config) {
+        qCWarning(KSCREEN_BACKEND_LAUNCHER) << "Backend provided an empty config!";
+        return QVariant();
+    }
+
+    ++mConfigCacheMisses;
+    mMarshalledConfig = KScreen::ConfigSerializer::marshalConfig(config);
+    return mMarshalledConfig;
 }
 
 QByteArray BackendDBusWrapper::getEdid(int output) const
@@ -88,6 +124,137 @@ QByteArray BackendDBusWrapper::getEdid(int output) const
     return edidData;
 }
 
+QMap<int, QByteArray> BackendDBusWrapper::getEdids(const QList<int> &outputs) const
+{
+    QMap<int, QByteArray> edids;
+    for (int output : outputs) {
+        const QByteArray edidData = mBackend->edid(output);
+        if (!edidData.isEmpty()) {
+            edids.insert(output, edidData);
+        }
+    }
+    return edids;
+}
+
+KScreen::ConfigSerializer::EdidHashes BackendDBusWrapper::edidHashes(const KScreen::ConfigPtr &config)
+{
+    KScreen::ConfigSerializer::EdidHashes hashes;
+    const auto outputs = config->outputs();
+    for (const KScreen::OutputPtr &output : outputs) {
+        if (!output->isConnected() || output->edid()) {
+            continue;
+        }
+        // Backends keep the EDID around, only parse it when it's not the one we hashed
+        const QByteArray edidData = mBackend->edid(output->id());
+        KnownEdid &known = mKnownEdids[output->id()];
+        if (known.data != edidData) {
+            known.data = edidData;
+            const KScreen::Edid edid(edidData);
+            known.hash = edid.isValid() ? edid.hash().toLatin1() : QByteArray();
+        }
+        if (!known.hash.isEmpty()) {
+            hashes.insert(output->id(), known.hash);
+        }
+    }
+    return hashes;
+}
+
+uint BackendDBusWrapper::negotiateCapabilities(uint clientCapabilities)
+{
+    const uint capabilities = clientCapabilities & KScreen::ConfigSerializer::supportedWireCapabilities;
+    if (capabilities & KScreen::ConfigSerializer::BinaryConfig) {
+        mBinaryClientSeen = true;
+        if (!(capabilities & KScreen::ConfigSerializer::SharedModeTable) && !mModeTableUnsupported) {
+            mModeTableUnsupported = true;
+            mSerializedConfigBinary.clear();
+        }
+    }
+    return capabilities;
+}
+
+QByteArray BackendDBusWrapper::getConfigV2()
+{
+    mBinaryClientSeen = true;
+
+    const QByteArray config = serializedConfigBinary();
+    // An empty reply means "unchanged" to getConfigIfChanged() callers, so
+    // failing must not look like one
+    if (config.isEmpty() && calledFromDBus()) {
+        sendErrorReply(QDBusError::Failed, QStringLiteral("Backend provided no config"));
+    }
+    return config;
+}
+
+QByteArray BackendDBusWrapper::getConfigIfChanged(qulonglong serial)
+{
+    // mCurrentConfig is only set while a change is waiting to be announced,
+    // the generation has not been bumped for it yet
+    if (serial == mGeneration && mCurrentConfig.isNull()) {
+        mBinaryClientSeen = true;
+        return QByteArray();
+    }
+    return getConfigV2();
+}
+
+QByteArray BackendDBusWrapper::setConfigV2(const QByteArray &configData)
+{
+    mBinaryClientSeen = true;
+
+    const KScreen::ConfigPtr config = KScreen::ConfigSerializer::deserializeConfigBinary(configData);
+    if (!config) {
+        qCWarning(KSCREEN_BACKEND_LAUNCHER) << "Received an invalid binary config";
+        return QByteArray();
+    }
+    return applyBinaryConfig(config, nullptr);
+}
+
+QByteArray BackendDBusWrapper::setConfigDelta(qulonglong baseGeneration, const QByteArray &delta)
+{
+    mBinaryClientSeen = true;
+
+    // Same condition as getConfigIfChanged(): the client's base must be what the
+    // backend currently has, not merely the last announced state
+    if (baseGeneration != mGeneration || !mCurrentConfig.isNull()) {
+        qCDebug(KSCREEN_BACKEND_LAUNCHER) << "Config delta against generation" << baseGeneration << "is outdated, current is" << mGeneration;
+        if (calledFromDBus()) {
+            sendErrorReply(QDBusError::InvalidArgs, QStringLiteral("Outdated base generation"));
+        }
+        return QByteArray();
+    }
+
+    const KScreen::ConfigPtr base = currentConfig();
+    if (!base) {
+        qCWarning(KSCREEN_BACKEND_LAUNCHER) << "Backend provided an empty config!";
+        return QByteArray();
+    }
+    const KScreen::ConfigPtr config = base->clone();
+    if (!KScreen::ConfigSerializer::applyConfigDelta(config, delta)) {
+        qCWarning(KSCREEN_BACKEND_LAUNCHER) << "Received an invalid config delta";
+        if (calledFromDBus()) {
+            sendErrorReply(QDBusError::InvalidArgs, QStringLiteral("Invalid config delta"));
+        }
+        return QByteArray();
+    }
+    const KScreen::ConfigChanges changes = config->diff(base);
+    return applyBinaryConfig(config, &changes);
+}
+
+QByteArray BackendDBusWrapper::applyBinaryConfig(const KScreen::ConfigPtr &config, const KScreen::ConfigChanges *changes)
+{
+    if (changes) {
+        mBackend->applyConfigChanges(config, *changes);
+    } else {
+        mBackend->setConfig(config);
+    }
+
+    mCurrentConfig = mBackend->config();
+    invalidateSerializedConfig();
+    QMetaObject::invokeMethod(this, "doEmitConfigChanged", Qt::QueuedConnection);
+
+    // The new state has no generation until the change is announced
+    return KScreen::ConfigSerializer::serializeConfigBinary(mCurrentConfig, 0, binaryFormat(), edidHashes(mCurrentConfig));
+}
+
 void BackendDBusWrapper::backendConfigChanged(const KScreen::ConfigPtr &config)
 {
     Q_ASSERT(!config.isNull());
@@ -97,7 +264,86 @@ void BackendDBusWrapper::backendConfigChanged(const KScreen::ConfigPtr &config)
     }
 
     mCurrentConfig = config;
-    mChangeCollector.start();
+    invalidateSerializedConfig();
+    mChangeCompressor.notify();
+}
+
+KScreen::ConfigPtr BackendDBusWrapper::currentConfig()
+{
+    if (!mCachedConfig) {
+        // A change waiting to be announced already carries the backend's config,
+        // don't make the backend build it again
+        mCachedConfig = mCurrentConfig ? mCurrentConfig : mBackend->config();
+    }
+    return mCachedConfig;
+}
+
+QByteArray BackendDBusWrapper::serializedConfigBinary()
+{
+    // The generation is part of the data, so it goes stale when a change is announced
+    if (!mSerializedConfigBinary.isEmpty() && mSerializedConfigBinaryGeneration == mGeneration) {
+        ++mConfigCacheHits;
+        return mSerializedConfigBinary;
+    }
+
+    const KScreen::ConfigPtr config = currentConfig();
+    if (!config) {
+        qCWarning(KSCREEN_BACKEND_LAUNCHER) << "Backend provided an empty config!";
+        return QByteArray();
+    }
+
+    ++mConfigCacheMisses;
+    mSerializedConfigBinary = KScreen::ConfigSerializer::serializeConfigBinary(config, mGeneration, binaryFormat(), edidHashes(config));
+    mSerializedConfigBinaryGeneration = mGeneration;
+    return mSerializedConfigBinary;
+}
+
+uint BackendDBusWrapper::binaryFormat() const
+{
+    return mModeTableUnsupported ? KScreen::ConfigSerializer::NoWireCapabilities : KScreen::ConfigSerializer::SharedModeTable;
+}
+
+void BackendDBusWrapper::invalidateSerializedConfig()
+{
+    mCachedConfig.clear();
+    mMarshalledConfig.clear();
+    mSerializedConfigBinary.clear();
+}
+
+QVariantMap BackendDBusWrapper::statistics() const
+{
+    // Ours and those of the backend, e.g. XRandR's, by name
+    QVariantMap changeLatencies;
+    changeLatencies.insert(mChangeCompressor.objectName(), mChangeCompressor.statistics());
+    const auto backendCompressors = mBackend->findChildren<KScreen::ChangeCompressor *>();
+    for (const KScreen::ChangeCompressor *compressor : backendCompressors) {
+        changeLatencies.insert(compressor->objectName(), compressor->statistics());
+    }
+
+    return {
+        {QStringLiteral("configCacheHits"), mConfigCacheHits},
+        {QStringLiteral("configCacheMisses"), mConfigCacheMisses},
+        {QStringLiteral("changeLatencies"), changeLatencies},
+    };
+}
+
+void BackendDBusWrapper::emitBinaryConfigChanged()
+{
+    KScreen::ConfigSerializer::EdidHashes hashes = edidHashes(mCurrentConfig);
+    if (!mLastEmittedConfig) {
+        ++mGeneration;
+        Q_EMIT configChangedV2(serializedConfigBinary());
+    } else {
+        const QByteArray delta = KScreen::ConfigSerializer::serializeConfigDelta(mLastEmittedConfig, mCurrentConfig, mLastEmittedEdidHashes, hashes);
+        if (delta.isEmpty()) {
+            return;
+        }
+        ++mGeneration;
+        Q_EMIT configDelta(mGeneration - 1, mGeneration, delta);
+    }
+    // Backends may keep modifying the object they handed us
+    mLastEmittedConfig = mCurrentConfig->clone();
+    mLastEmittedEdidHashes = std::move(hashes);
 }
 
 void BackendDBusWrapper::doEmitConfigChanged()
@@ -107,9 +353,22 @@ void BackendDBusWrapper::doEmitConfigChanged()
         return;
     }
 
-    const QJsonObject obj = KScreen::ConfigSerializer::serializeConfig(mCurrentConfig);
-    Q_EMIT configChanged(obj.toVariantMap());
+    // Clients which negotiated the binary format only listen to configChangedV2
+    // and configDelta. Every binary client negotiates before it listens, also
+    // after a launcher restart, so nobody misses them.
+    if (mBinaryClientSeen) {
+        emitBinaryConfigChanged();
+    }
+
+    // A client may listen to configChanged without ever calling us, so it is
+    // always sent. Sent by hand rather than through the adaptor, so that the
+    // config is marshalled once for the signal and the getConfig() replies
+    // following it instead of going through a QVariantMap. mCurrentConfig is
+    // what currentConfig() returns while a change is pending.
+    QDBusMessage signal = QDBusMessage::createSignal(QStringLiteral("/backend"), QStringLiteral("org.kde.kscreen.Backend"), QStringLiteral("configChanged"));
+    signal << marshalledConfig();
+    QDBusConnection::sessionBus().send(signal);
 
     mCurrentConfig.clear();
-    mChangeCollector.stop();
+    mChangeCompressor.cancel();
 }
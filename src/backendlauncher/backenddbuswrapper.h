@@ -8,31 +8,45 @@
 #ifndef BACKENDDBUSWRAPPER_H
 #define BACKENDDBUSWRAPPER_H
 
+#include <QDBusContext>
 #include <QObject>
-#include <QTimer>
 #include <QVariant>
 
+#include "changecompressor_p.h"
+#include "configserializer_p.h"
 #include "types.h"
 
 namespace KScreen
 {
 class AbstractBackend;
+struct ConfigChanges;
 }
 
-class BackendDBusWrapper : public QObject
+class BackendDBusWrapper : public QObject, protected QDBusContext
 {
     Q_OBJECT
     Q_CLASSINFO("D-Bus Interface", "org.kde.KScreen.Backend")
 
 public:
-    explicit BackendDBusWrapper(KScreen::AbstractBackend *backend);
+    // @p arguments tune how changes are collected, see KScreen::ChangeCompressor
+    explicit BackendDBusWrapper(KScreen::AbstractBackend *backend, const QVariantMap &arguments = QVariantMap());
     ~BackendDBusWrapper() override;
 
     bool init();
 
-    QVariantMap getConfig() const;
+    QVariantMap getConfig();
     QVariantMap setConfig(const QVariantMap &config);
     QByteArray getEdid(int output) const;
+    QMap<int, QByteArray> getEdids(const QList<int> &outputs) const;
+
+    uint negotiateCapabilities(uint clientCapabilities);
+    QByteArray getConfigV2();
+    QByteArray setConfigV2(const QByteArray &config);
+    QByteArray setConfigDelta(qulonglong baseGeneration, const QByteArray &delta);
+    QByteArray getConfigIfChanged(qulonglong serial);
+
+    // Counters and change latencies for monitoring, e.g. `qdbus org.kde.KScreen /backend statistics`
+    QVariantMap statistics() const;
 
     inline KScreen::AbstractBackend *backend() const
     {
@@ -40,16 +54,64 @@ public:
     }
 
 Q_SIGNALS:
+    // Sent by hand in doEmitConfigChanged(), declared for the adaptor
     void configChanged(const QVariantMap &config);
+    void configChangedV2(const QByteArray &config);
+    void configDelta(qulonglong baseGeneration, qulonglong generation, const QByteArray &delta);
 
 private Q_SLOTS:
     void backendConfigChanged(const KScreen::ConfigPtr &config);
     void doEmitConfigChanged();
 
 private:
+    void emitBinaryConfigChanged();
+    KScreen::ConfigPtr currentConfig();
+    // Replies with the current config, sent by hand when called over D-Bus
+    QVariantMap replyWithConfig();
+    // currentConfig() marshalled for replies and the configChanged signal
+    QVariant marshalledConfig();
+    QByteArray serializedConfigBinary();
+    // Hands @p config to the backend and replies with the config it ended up with
+    QByteArray applyBinaryConfig(const KScreen::ConfigPtr &config, const KScreen::ConfigChanges *changes);
+    // The wire capabilities binary configs are written with
+    uint binaryFormat() const;
+    void invalidateSerializedConfig();
+    // The EDID hashes of the connected outputs, to send with binary configs so
+    // that clients which already know an EDID don't fetch it
+    KScreen::ConfigSerializer::EdidHashes edidHashes(const KScreen::ConfigPtr &config);
+
     KScreen::AbstractBackend *mBackend = nullptr;
-    QTimer mChangeCollector;
+    KScreen::ChangeCompressor mChangeCompressor;
     KScreen::ConfigPtr mCurrentConfig;
+
+    // Bumped for every change announced to binary clients. mLastEmittedConfig
+    // is the state at mGeneration, the base for the next configDelta. Starts at
+    // the launch time, so that a restarted launcher never reuses generations.
+    quint64 mGeneration;
+    KScreen::ConfigPtr mLastEmittedConfig;
+    KScreen::ConfigSerializer::EdidHashes mLastEmittedEdidHashes;
+
+    // The EDID last seen for each output and its hash
+    struct KnownEdid {
+        QByteArray data;
+        QByteArray hash;
+    };
+    QHash<int, KnownEdid> mKnownEdids;
+
+    // The current config and its serializations, built once and shared by all
+    // clients until the backend reports a change
+    KScreen::ConfigPtr mCachedConfig;
+    QVariant mMarshalledConfig;
+    QByteArray mSerializedConfigBinary;
+    quint64 mSerializedConfigBinaryGeneration = 0;
+    quint64 mConfigCacheHits = 0;
+    quint64 mConfigCacheMisses = 0;
+
+    // Whether anyone negotiated the binary format and listens to its signals
+    bool mBinaryClientSeen = false;
+    // Binary configs are broadcast, so once a client that can't read the mode
+    // table shows up, all of them get inline modes
+    bool mModeTableUnsupported = false;
 };
 
 #endif // BACKENDDBUSWRAPPER_H
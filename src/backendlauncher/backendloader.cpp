@@ -88,7 +88,7 @@ bool BackendLoader::requestBackend(const QString &backendName, const QVariantMap
         return false;
     }
 
-    mBackend = new BackendDBusWrapper(backend);
+    mBackend = new BackendDBusWrapper(backend, arguments);
     if (!mBackend->init()) {
         delete mBackend;
         mBackend = nullptr;
@@ -12,12 +12,14 @@
 #include "backendinterface.h"
 #include "configmonitor.h"
 #include "configserializer_p.h"
+#include "edidcache_p.h"
 #include "getconfigoperation.h"
 #include "kscreen_debug.h"
 #include "log.h"
 
 #include <QDBusConnection>
 #include <QDBusConnectionInterface>
+#include <QDBusMetaType>
 #include <QDBusPendingCall>
 #include <QDBusPendingCallWatcher>
 #include <QDBusPendingReply>
@@ -27,6 +29,7 @@
 #include <QtGui/private/qtx11extras_p.h>
 
 #include <memory>
+#include <utility>
 
 using namespace KScreen;
 
@@ -34,6 +37,9 @@ Q_DECLARE_METATYPE(org::kde::kscreen::Backend *)
 
 const int BackendManager::sMaxCrashCount = 4;
 
+// Deltas kept undecoded at most, each one is small but they pile up
+constexpr qsizetype s_maxPendingDeltas = 32;
+
 BackendManager *BackendManager::sInstance = nullptr;
 
 BackendManager *BackendManager::instance()
@@ -48,6 +54,8 @@ BackendManager *BackendManager::instance()
 BackendManager::BackendManager()
     : mInterface(nullptr)
     , mCrashCount(0)
+    , mWireCapabilities(ConfigSerializer::NoWireCapabilities)
+    , mNegotiatingCapabilities(false)
     , mShuttingDown(false)
     , mRequestsCounter(0)
     , mLoader(nullptr)
@@ -81,6 +89,8 @@ void BackendManager::initMethod()
 {
     if (mMethod == OutOfProcess) {
         qRegisterMetaType<org::kde::kscreen::Backend *>("OrgKdeKscreenBackendInterface");
+        qDBusRegisterMetaType<QMap<int, QByteArray>>();
+        ConfigSerializer::registerDBusTypes();
 
         mServiceWatcher.setConnection(QDBusConnection::sessionBus());
         connect(&mServiceWatcher, &QDBusServiceWatcher::serviceUnregistered, this, &BackendManager::backendServiceUnregistered);
@@ -108,6 +118,11 @@ BackendManager::Method BackendManager::method() const
     return mMethod;
 }
 
+uint BackendManager::wireCapabilities() const
+{
+    return mWireCapabilities;
+}
+
 BackendManager::~BackendManager()
 {
     if (mMethod == InProcess) {
@@ -245,7 +260,9 @@ KScreen::AbstractBackend *BackendManager::loadBackendInProcess(const QString &na
 void BackendManager::requestBackend()
 {
     Q_ASSERT(mMethod == OutOfProcess);
-    if (mInterface && mInterface->isValid()) {
+    // While the wire format is being negotiated the interface is not ready for
+    // use yet, the request will be served by the pending backendReady().
+    if (mInterface && mInterface->isValid() && !mNegotiatingCapabilities) {
         ++mRequestsCounter;
         QMetaObject::invokeMethod(this, "emitBackendReady", Qt::QueuedConnection);
         return;
@@ -329,15 +346,157 @@ void BackendManager::onBackendRequestDone(QDBusPendingCallWatcher *watcher)
     // can invalidate the interface
     mServiceWatcher.addWatchedService(mBackendService);
 
+    // Agree on the wire format before transferring any config. Launchers that
+    // predate the negotiation reply with UnknownMethod, in which case we stay
+    // on the a{sv} format.
+    mNegotiatingCapabilities = true;
+    QDBusPendingCallWatcher *capsWatcher = new QDBusPendingCallWatcher(mInterface->negotiateCapabilities(ConfigSerializer::supportedWireCapabilities), this);
+    connect(capsWatcher, &QDBusPendingCallWatcher::finished, this, &BackendManager::onCapabilitiesNegotiated);
+}
+
+void BackendManager::onCapabilitiesNegotiated(QDBusPendingCallWatcher *watcher)
+{
+    Q_ASSERT(mMethod == OutOfProcess);
+    watcher->deleteLater();
+    mNegotiatingCapabilities = false;
+    if (!mInterface) {
+        // Interface got invalidated in the meantime, let the waiting requests fail
+        emitBackendReady();
+        return;
+    }
+
+    QDBusPendingReply<uint> reply = *watcher;
+    if (reply.isError()) {
+        qCDebug(KSCREEN) << "Backend launcher does not support wire format negotiation:" << reply.error().message();
+        mWireCapabilities = ConfigSerializer::NoWireCapabilities;
+    } else {
+        mWireCapabilities = reply.value() & ConfigSerializer::supportedWireCapabilities;
+    }
+
+    if (mWireCapabilities & ConfigSerializer::BinaryConfig) {
+        // Listen for changes, which arrive as deltas against the last known generation
+        connect(mInterface, &org::kde::kscreen::Backend::configChangedV2, this, &BackendManager::onBinaryConfigChanged);
+        connect(mInterface, &org::kde::kscreen::Backend::configDelta, this, &BackendManager::onConfigDelta);
+
+        // Immediately request config. This does not go through GetConfigOperation
+        // because we need to know which generation the config belongs to.
+        connect(fetchBinaryConfig(), &QDBusPendingCallWatcher::finished, this, &BackendManager::emitBackendReady);
+        return;
+    }
+
     // Immediatelly request config
     connect(new GetConfigOperation(GetConfigOperation::NoEDID), &GetConfigOperation::finished, [&](ConfigOperation *op) {
         mConfig = qobject_cast<GetConfigOperation *>(op)->config();
         emitBackendReady();
     });
     // And listen for its change.
-    connect(mInterface, &org::kde::kscreen::Backend::configChanged, [&](const QVariantMap &newConfig) {
-        mConfig = KScreen::ConfigSerializer::deserializeConfig(newConfig);
-    });
+    connect(mInterface, &org::kde::kscreen::Backend::configChanged, this, &BackendManager::onConfigChanged);
+}
+
+QDBusPendingCallWatcher *BackendManager::fetchBinaryConfig()
+{
+    mFetchingConfig = true;
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(mInterface->getConfigV2(), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, &BackendManager::onBinaryConfigReceived);
+    return watcher;
+}
+
+void BackendManager::onBinaryConfigReceived(QDBusPendingCallWatcher *watcher)
+{
+    watcher->deleteLater();
+    mFetchingConfig = false;
+    const bool notify = std::exchange(mNotifyOnFetch, false);
+    const QDBusPendingReply<QByteArray> reply = *watcher;
+    if (reply.isError()) {
+        qCWarning(KSCREEN) << "Failed to retrieve current config:" << reply.error().message();
+        return;
+    }
+
+    if (const ConfigPtr config = ConfigSerializer::deserializeConfigBinary(reply.value())) {
+        mConfig = config;
+        discardPendingConfig();
+        // Changes that arrived while the request was in flight may still apply
+        mPendingDeltas.removeIf([&config](const PendingDelta &delta) {
+            return delta.generation <= config->serial();
+        });
+    }
+    if (notify) {
+        Q_EMIT configReceived();
+    }
+}
+
+// Every process using libkscreen receives every change, most of them never
+// look at the config. Notifications are kept as they came in and decoded only
+// once, when config() is called, for BackendManager and ConfigMonitor alike.
+
+void BackendManager::onConfigChanged(const QVariantMap &configMap)
+{
+    discardPendingConfig();
+    mPendingConfig = configMap;
+    mPendingDeltas.clear();
+    Q_EMIT configReceived();
+}
+
+void BackendManager::onBinaryConfigChanged(const QByteArray &configData)
+{
+    mPendingConfig = configData;
+    mPendingDeltas.clear();
+    Q_EMIT configReceived();
+}
+
+void BackendManager::onConfigDelta(qulonglong baseGeneration, qulonglong generation, const QByteArray &delta)
+{
+    mPendingDeltas.append(PendingDelta{baseGeneration, generation, delta});
+    // Don't let a process that never reads the config hoard them
+    if (mPendingDeltas.size() >= s_maxPendingDeltas) {
+        decodePendingConfig();
+    }
+    Q_EMIT configReceived();
+}
+
+void BackendManager::resyncConfig()
+{
+    mNotifyOnFetch = true;
+    if (!mFetchingConfig && mInterface) {
+        fetchBinaryConfig();
+    }
+}
+
+void BackendManager::decodePendingConfig()
+{
+    if (const auto *configMap = std::get_if<QVariantMap>(&mPendingConfig)) {
+        // Maps don't carry EDID hashes, and the launcher coalesces changes: an output
+        // unplugged and replugged with another monitor looks like it stayed connected
+        EdidCache::instance()->forgetConnections();
+        if (const ConfigPtr config = ConfigSerializer::deserializeConfig(*configMap)) {
+            mConfig = config;
+        }
+    } else if (const auto *configData = std::get_if<QByteArray>(&mPendingConfig)) {
+        if (const ConfigPtr config = ConfigSerializer::deserializeConfigBinary(*configData)) {
+            mConfig = config;
+        }
+    }
+    mPendingConfig = std::monostate();
+
+    if (mPendingDeltas.isEmpty()) {
+        return;
+    }
+    const QList<PendingDelta> deltas = std::exchange(mPendingDeltas, {});
+    // Callers of config() may hold on to the current object, don't change it under them
+    const ConfigPtr config = mConfig ? mConfig->clone() : ConfigPtr();
+    for (const PendingDelta &delta : deltas) {
+        if (!config || delta.baseGeneration != config->serial()) {
+            qCDebug(KSCREEN) << "Config generation" << delta.baseGeneration << "is unknown, refetching config";
+            QMetaObject::invokeMethod(this, &BackendManager::resyncConfig, Qt::QueuedConnection);
+            return;
+        }
+        if (!ConfigSerializer::applyConfigDelta(config, delta.delta)) {
+            QMetaObject::invokeMethod(this, &BackendManager::resyncConfig, Qt::QueuedConnection);
+            return;
+        }
+        config->setSerial(delta.generation);
+    }
+    mConfig = config;
 }
 
 void BackendManager::backendServiceUnregistered(const QString &serviceName)
@@ -354,11 +513,18 @@ void BackendManager::invalidateInterface()
     Q_ASSERT(mMethod == OutOfProcess);
     delete mInterface;
     mInterface = nullptr;
+    mWireCapabilities = ConfigSerializer::NoWireCapabilities;
+    mNegotiatingCapabilities = false;
     mBackendService.clear();
+    // Generations are only meaningful for the launcher that issued them
+    mPendingDeltas.clear();
+    mFetchingConfig = false;
+    mNotifyOnFetch = false;
 }
 
-ConfigPtr BackendManager::config() const
+ConfigPtr BackendManager::config()
 {
+    decodePendingConfig();
     return mConfig;
 }
 
@@ -366,6 +532,17 @@ void BackendManager::setConfig(ConfigPtr c)
 {
     // qCDebug(KSCREEN) << "BackendManager::setConfig, outputs:" << c->outputs().count();
     mConfig = c;
+    discardPendingConfig();
+    mPendingDeltas.clear();
+}
+
+void BackendManager::discardPendingConfig()
+{
+    // Like decoding it, see decodePendingConfig()
+    if (std::holds_alternative<QVariantMap>(mPendingConfig)) {
+        EdidCache::instance()->forgetConnections();
+    }
+    mPendingConfig = std::monostate();
 }
 
 void BackendManager::shutdownBackend()
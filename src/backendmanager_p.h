@@ -23,6 +23,8 @@
 #include <QProcess>
 #include <QTimer>
 
+#include <variant>
+
 #include "kscreen_export.h"
 #include "types.h"
 
@@ -46,7 +48,12 @@ public:
     static BackendManager *instance();
     ~BackendManager() override;
 
-    KScreen::ConfigPtr config() const;
+    /**
+     * @return the current config of the backend. Change notifications are only
+     * decoded here, the first time the config is read after them. The config
+     * is shared by all readers and must not be modified.
+     */
+    KScreen::ConfigPtr config();
     void setConfig(KScreen::ConfigPtr c);
 
     /** Choose which backend to use
@@ -107,6 +114,13 @@ public:
     BackendManager::Method method() const;
     void setMethod(BackendManager::Method m);
 
+    /** Wire format features agreed on with the out-of-process backend
+     *
+     * @return ConfigSerializer::WireCapability flags, 0 when the launcher only
+     * speaks the original a{sv} format or runs in-process.
+     */
+    uint wireCapabilities() const;
+
     // For out-of-process operation
     void requestBackend();
     void shutdownBackend();
@@ -114,11 +128,23 @@ public:
 Q_SIGNALS:
     void backendReady(OrgKdeKscreenBackendInterface *backend);
 
+    /**
+     * The out-of-process backend reported a change of its config, read it
+     * through config().
+     */
+    void configReceived();
+
 private Q_SLOTS:
     void emitBackendReady();
 
     void startBackend(const QString &backend = QString(), const QVariantMap &arguments = QVariantMap());
     void onBackendRequestDone(QDBusPendingCallWatcher *watcher);
+    void onCapabilitiesNegotiated(QDBusPendingCallWatcher *watcher);
+    void onBinaryConfigReceived(QDBusPendingCallWatcher *watcher);
+    void onConfigChanged(const QVariantMap &configMap);
+    void onBinaryConfigChanged(const QByteArray &configData);
+    void onConfigDelta(qulonglong baseGeneration, qulonglong generation, const QByteArray &delta);
+    void resyncConfig();
 
     void backendServiceUnregistered(const QString &serviceName);
 
@@ -136,6 +162,10 @@ private:
     // For out-of-process operation
     void invalidateInterface();
     void backendServiceReady();
+    QDBusPendingCallWatcher *fetchBinaryConfig();
+    void decodePendingConfig();
+    // Drops a notification that was never decoded
+    void discardPendingConfig();
 
     static const int sMaxCrashCount;
     OrgKdeKscreenBackendInterface *mInterface;
@@ -144,6 +174,18 @@ private:
     QString mBackendService;
     QDBusServiceWatcher mServiceWatcher;
     KScreen::ConfigPtr mConfig;
+    // Last change notification not decoded yet, and the deltas received after it
+    std::variant<std::monostate, QVariantMap, QByteArray> mPendingConfig;
+    struct PendingDelta {
+        qulonglong baseGeneration;
+        qulonglong generation;
+        QByteArray delta;
+    };
+    QList<PendingDelta> mPendingDeltas;
+    bool mFetchingConfig = false;
+    bool mNotifyOnFetch = false;
+    uint mWireCapabilities;
+    bool mNegotiatingCapabilities;
     QVariantMap mBackendArguments;
     QTimer mResetCrashCountTimer;
     bool mShuttingDown;
@@ -0,0 +1,164 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#include "changecompressor_p.h"
+#include "kscreen_debug.h"
+
+#include <algorithm>
+
+using namespace KScreen;
+
+namespace
+{
+int argumentValue(const QVariantMap &arguments, const QString &argument, bool *ok)
+{
+    const QVariant value = arguments.value(argument);
+    if (!value.isValid()) {
+        *ok = false;
+        return 0;
+    }
+    const int result = value.toInt(ok);
+    if (!*ok) {
+        qCWarning(KSCREEN) << "Ignoring invalid value" << value << "of" << argument;
+    }
+    return result;
+}
+
+// The environment wins over the arguments, which win over the default. The
+// settings of the compressor named @p name win over those of every compressor.
+int setting(const QVariantMap &arguments, const QString &name, const QString &argument, const QByteArray &variable, int defaultValue)
+{
+    const QByteArray stageVariable = "KSCREEN_" + name.toUpper().toLatin1() + '_' + variable;
+    const QByteArray sharedVariable = "KSCREEN_" + variable;
+    bool ok = false;
+    for (const QByteArray &candidate : {stageVariable, sharedVariable}) {
+        const int environment = qEnvironmentVariableIntValue(candidate.constData(), &ok);
+        if (ok) {
+            return environment;
+        }
+    }
+
+    const QString stageArgument = name + argument.front().toUpper() + argument.mid(1);
+    for (const QString &candidate : {stageArgument, argument}) {
+        const int value = argumentValue(arguments, candidate, &ok);
+        if (ok) {
+            return value;
+        }
+    }
+    return defaultValue;
+}
+}
+
+ChangeCompressor::ChangeCompressor(const QString &name, int quietPeriod, int maxLatency, QObject *parent)
+    : QObject(parent)
+    , mQuietPeriod(quietPeriod)
+    , mMaxLatency(maxLatency)
+{
+    setObjectName(name);
+    mTimer.setSingleShot(true);
+    connect(&mTimer, &QTimer::timeout, this, &ChangeCompressor::fire);
+}
+
+void ChangeCompressor::configure(const QVariantMap &arguments)
+{
+    const QString name = objectName();
+    mQuietPeriod = std::max(setting(arguments, name, QStringLiteral("changeQuietPeriod"), QByteArrayLiteral("CHANGE_QUIET_PERIOD"), mQuietPeriod), 0);
+    mMaxLatency = std::max(setting(arguments, name, QStringLiteral("changeMaxLatency"), QByteArrayLiteral("CHANGE_MAX_LATENCY"), mMaxLatency), 0);
+    mLeadingEdge = setting(arguments, name, QStringLiteral("changeLeadingEdge"), QByteArrayLiteral("CHANGE_LEADING_EDGE"), mLeadingEdge) != 0;
+    qCDebug(KSCREEN) << objectName() << "reports changes after" << mQuietPeriod << "ms without change, at most after" << mMaxLatency << "ms"
+                     << (mLeadingEdge ? "or right away when idle" : "");
+}
+
+void ChangeCompressor::notify()
+{
+    ++mChanges;
+    if (!mPending) {
+        mPending = true;
+        mFirstChange.start();
+    }
+
+    if (mTimer.isActive() && mTimer.interval() == 0) {
+        // Reported once the event loop is back, this change included
+        return;
+    }
+    const bool idle = !mLastTrigger.isValid() || mLastTrigger.elapsed() >= mQuietPeriod;
+    if (mLeadingEdge && idle) {
+        // Not right here, the caller usually still has to apply the change
+        mTimer.start(0);
+        return;
+    }
+
+    const qint64 remaining = std::max<qint64>(mMaxLatency - mFirstChange.elapsed(), 0);
+    mTimer.start(int(std::min<qint64>(mQuietPeriod, remaining)));
+}
+
+void ChangeCompressor::cancel()
+{
+    mTimer.stop();
+    mPending = false;
+}
+
+bool ChangeCompressor::isPending() const
+{
+    return mPending;
+}
+
+int ChangeCompressor::quietPeriod() const
+{
+    return mQuietPeriod;
+}
+
+int ChangeCompressor::maxLatency() const
+{
+    return mMaxLatency;
+}
+
+bool ChangeCompressor::leadingEdge() const
+{
+    return mLeadingEdge;
+}
+
+void ChangeCompressor::fire()
+{
+    if (!mPending) {
+        return;
+    }
+    mPending = false;
+
+    const qint64 latency = mFirstChange.elapsed();
+    const auto bucket = std::lower_bound(s_latencyBounds.cbegin(), s_latencyBounds.cend(), latency);
+    ++mLatencyCounts[std::distance(s_latencyBounds.cbegin(), bucket)];
+    mLatencyMax = std::max(mLatencyMax, latency);
+    mLatencyTotal += latency;
+    ++mTriggers;
+
+    mLastTrigger.start();
+    Q_EMIT triggered();
+}
+
+QVariantMap ChangeCompressor::statistics() const
+{
+    QVariantList bounds;
+    for (int bound : s_latencyBounds) {
+        bounds << bound;
+    }
+    QVariantList counts;
+    for (quint64 count : mLatencyCounts) {
+        counts << count;
+    }
+    return {
+        {QStringLiteral("changes"), mChanges},
+        {QStringLiteral("triggers"), mTriggers},
+        {QStringLiteral("quietPeriod"), mQuietPeriod},
+        {QStringLiteral("maxLatency"), mMaxLatency},
+        {QStringLiteral("leadingEdge"), mLeadingEdge},
+        {QStringLiteral("latencyBounds"), bounds},
+        {QStringLiteral("latencyCounts"), counts},
+        {QStringLiteral("latencyMax"), mLatencyMax},
+        {QStringLiteral("latencyTotal"), mLatencyTotal},
+    };
+}
@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#ifndef KSCREEN_CHANGECOMPRESSOR_P_H
+#define KSCREEN_CHANGECOMPRESSOR_P_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QVariantMap>
+
+#include <array>
+
+#include "kscreen_export.h"
+
+namespace KScreen
+{
+/**
+ * Turns bursts of change events into few notifications.
+ *
+ * The first change after a quiet period is reported right away, once control
+ * is back in the event loop. Changes following it are collected until none
+ * came for the quiet period, but never held back longer than the maximum
+ * latency after the first one.
+ *
+ * The timings are read by configure() from these backend arguments, or from
+ * the environment variables in brackets, which win:
+ *  - changeQuietPeriod (KSCREEN_CHANGE_QUIET_PERIOD): milliseconds
+ *  - changeMaxLatency (KSCREEN_CHANGE_MAX_LATENCY): milliseconds
+ *  - changeLeadingEdge (KSCREEN_CHANGE_LEADING_EDGE): 0 to always wait for the
+ *    end of a burst
+ *
+ * These apply to every compressor, e.g. both the backend's and the launcher's,
+ * overriding their different defaults. A single one is tuned by prefixing the
+ * argument with its name, e.g. xrandrChangeQuietPeriod, or the variable with
+ * its upper-cased name, e.g. KSCREEN_XRANDR_CHANGE_QUIET_PERIOD. Those win over
+ * the shared settings of the same kind.
+ *
+ * The time from the first change to the notification is recorded, see
+ * statistics().
+ */
+class KSCREEN_EXPORT ChangeCompressor : public QObject
+{
+    Q_OBJECT
+
+public:
+    ChangeCompressor(const QString &name, int quietPeriod, int maxLatency, QObject *parent = nullptr);
+
+    void configure(const QVariantMap &arguments);
+
+    /**
+     * Something changed, triggered() will follow
+     */
+    void notify();
+
+    /**
+     * Drops the changes not reported yet
+     */
+    void cancel();
+
+    bool isPending() const;
+
+    int quietPeriod() const;
+    int maxLatency() const;
+    bool leadingEdge() const;
+
+    /**
+     * @return counters and the latency histogram: latencyCounts[i] notifications
+     * took at most latencyBounds[i] milliseconds, the last one counts the
+     * slower ones
+     */
+    QVariantMap statistics() const;
+
+Q_SIGNALS:
+    void triggered();
+
+private:
+    void fire();
+
+    static constexpr std::array<int, 12> s_latencyBounds = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+
+    QTimer mTimer;
+    int mQuietPeriod;
+    int mMaxLatency;
+    bool mLeadingEdge = true;
+
+    bool mPending = false;
+    QElapsedTimer mFirstChange;
+    QElapsedTimer mLastTrigger;
+
+    quint64 mChanges = 0;
+    quint64 mTriggers = 0;
+    std::array<quint64, s_latencyBounds.size() + 1> mLatencyCounts = {};
+    qint64 mLatencyMax = 0;
+    qint64 mLatencyTotal = 0;
+};
+
+}
+
+#endif // KSCREEN_CHANGECOMPRESSOR_P_H
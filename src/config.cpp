@@ -8,6 +8,8 @@
 #include "config.h"
 
 #include "backendmanager_p.h"
+#include "configvalidator_p.h"
+#include "fingerprint_p.h"
 #include "kscreen_debug.h"
 #include "mode.h"
 
@@ -15,6 +17,7 @@
 #include <QDebug>
 #include <QRect>
 #include <QStringList>
+#include <QVarLengthArray>
 
 #include <algorithm>
 #include <utility>
@@ -31,6 +34,7 @@ public:
         , supportedFeatures(Config::Feature::None)
         , tabletModeAvailable(false)
         , tabletModeEngaged(false)
+        , serial(0)
         , q(parent)
     {
     }
@@ -57,124 +61,172 @@ public:
 
         if (output) {
             output->disconnect(q);
+            invalidateGeometry();
+            if (updateDepth > 0) {
+                output->endUpdate();
+            }
             Q_EMIT q->outputRemoved(outputId);
         }
 
         return iter;
     }
 
+    struct OutputGeometry {
+        OutputPtr output;
+        QRect rect;
+    };
+
+    struct GeometryIndex {
+        // Sorted by priority, so lookups find the most important output first
+        QList<OutputGeometry> outputs;
+        QRect boundingRect;
+        bool overlaps = false;
+        // The size enforcedModeSize() returned for each output placed, in the order
+        // of outputs. The preferred modes and the Mode objects can change without
+        // a signal, so they are checked on every lookup.
+        QList<QSize> modeSizes;
+    };
+
+    const GeometryIndex &geometryIndex()
+    {
+        // The outputs hold back the signals invalidating the index during an update
+        if (!geometry || updateDepth > 0 || !modeSizesMatch(*geometry)) {
+            geometry = buildGeometryIndex();
+        }
+        return *geometry;
+    }
+
+    void invalidateGeometry()
+    {
+        geometry.reset();
+    }
+
+    // Whether the config-wide properties Config::apply() takes over differ
+    bool propertiesDiffer(const Private &other) const
+    {
+        if (supportedFeatures != other.supportedFeatures || tabletModeAvailable != other.tabletModeAvailable || tabletModeEngaged != other.tabletModeEngaged
+            || valid != other.valid) {
+            return true;
+        }
+        if (!screen || !other.screen) {
+            return other.screen && !screen;
+        }
+        return screen->currentSize() != other.screen->currentSize() || screen->maxActiveOutputsCount() != other.screen->maxActiveOutputsCount();
+    }
+
     bool valid;
     ScreenPtr screen;
     OutputList outputs;
     Features supportedFeatures;
     bool tabletModeAvailable;
     bool tabletModeEngaged;
+    quint64 serial;
+    std::optional<GeometryIndex> geometry;
+    int updateDepth = 0;
+    bool prioritiesPending = false;
+    std::optional<OutputPtr> pendingKeep;
 
 private:
-    Config *q;
-};
-
-bool Config::canBeApplied(const ConfigPtr &config)
-{
-    return canBeApplied(config, ValidityFlag::None);
-}
-
-bool Config::canBeApplied(const ConfigPtr &config, ValidityFlags flags)
-{
-    if (!config) {
-        qCDebug(KSCREEN) << "canBeApplied: Config not available, returning false";
-        return false;
-    }
-    ConfigPtr currentConfig = BackendManager::instance()->config();
-    if (!currentConfig) {
-        qCDebug(KSCREEN) << "canBeApplied: Current config not available, returning false";
-        return false;
+    static bool isPlaced(const Output &output)
+    {
+        return output.isConnected() && output.isEnabled() && output.replicationSource() == 0;
     }
 
-    QRect rect;
-    OutputPtr currentOutput;
-    const OutputList outputs = config->outputs();
-    int enabledOutputsCount = 0;
-    for (const OutputPtr &output : outputs) {
-        if (!output->isEnabled()) {
-            continue;
+    bool modeSizesMatch(const GeometryIndex &index) const
+    {
+        qsizetype i = 0;
+        for (const OutputPtr &output : std::as_const(outputs)) {
+            if (!isPlaced(*output)) {
+                continue;
+            }
+            if (i >= index.modeSizes.size() || index.modeSizes[i++] != output->enforcedModeSize()) {
+                return false;
+            }
         }
+        return i == index.modeSizes.size();
+    }
 
-        ++enabledOutputsCount;
-
-        currentOutput = currentConfig->output(output->id());
-        // If there is no such output
-        if (!currentOutput) {
-            qCDebug(KSCREEN) << "canBeApplied: The output:" << output->id() << "does not exists";
-            return false;
-        }
-        // If the output is not connected
-        if (!currentOutput->isConnected()) {
-            qCDebug(KSCREEN) << "canBeApplied: The output:" << output->id() << "is not connected";
-            return false;
-        }
-        // if there is no currentMode
-        if (output->currentModeId().isEmpty()) {
-            qCDebug(KSCREEN) << "canBeApplied: The output:" << output->id() << "has no currentModeId";
-            return false;
-        }
-        // If the mode is not found in the current output
-        if (!currentOutput->mode(output->currentModeId())) {
-            qCDebug(KSCREEN) << "canBeApplied: The output:" << output->id() << "has no mode:" << output->currentModeId();
-            return false;
+    GeometryIndex buildGeometryIndex() const
+    {
+        GeometryIndex index;
+        for (const OutputPtr &output : std::as_const(outputs)) {
+            if (!isPlaced(*output)) {
+                continue;
+            }
+            index.modeSizes.append(output->enforcedModeSize());
+            const QRect rect = q->outputGeometryForOutput(*output);
+            if (rect.isValid()) {
+                index.outputs.append({output, rect});
+                index.boundingRect |= rect;
+            }
         }
+        std::stable_sort(index.outputs.begin(), index.outputs.end(), [](const OutputGeometry &a, const OutputGeometry &b) {
+            return a.output->priority() < b.output->priority();
+        });
 
-        const ModePtr currentMode = output->currentMode();
-
-        const QSize outputSize = currentMode->size();
-
-        if (output->pos().x() < rect.x()) {
-            rect.setX(output->pos().x());
+        // Sweep from left to right, only outputs starting before the current one ends can overlap it
+        QList<QRect> rects;
+        rects.reserve(index.outputs.size());
+        for (const OutputGeometry &entry : std::as_const(index.outputs)) {
+            rects.append(entry.rect);
         }
-
-        if (output->pos().y() < rect.y()) {
-            rect.setY(output->pos().y());
+        std::sort(rects.begin(), rects.end(), [](const QRect &a, const QRect &b) {
+            return a.left() < b.left();
+        });
+        for (qsizetype i = 0; i < rects.size() && !index.overlaps; ++i) {
+            for (qsizetype j = i + 1; j < rects.size() && rects[j].left() <= rects[i].right(); ++j) {
+                if (rects[i].intersects(rects[j])) {
+                    index.overlaps = true;
+                    break;
+                }
+            }
         }
+        return index;
+    }
 
-        QPoint bottomRight;
-        if (output->isHorizontal()) {
-            bottomRight = QPoint(output->pos().x() + outputSize.width(), output->pos().y() + outputSize.height());
-        } else {
-            bottomRight = QPoint(output->pos().x() + outputSize.height(), output->pos().y() + outputSize.width());
-        }
+    Config *q;
+};
 
-        if (bottomRight.x() > rect.width()) {
-            rect.setWidth(bottomRight.x());
-        }
+bool ConfigChanges::isEmpty() const
+{
+    return !configChanged && addedOutputs.isEmpty() && removedOutputs.isEmpty() && changedOutputs.isEmpty();
+}
 
-        if (bottomRight.y() > rect.height()) {
-            rect.setHeight(bottomRight.y());
-        }
+bool ConfigChanges::affects(Output::Changes changes) const
+{
+    if (!addedOutputs.isEmpty() || !removedOutputs.isEmpty()) {
+        return true;
     }
+    return std::any_of(changedOutputs.cbegin(), changedOutputs.cend(), [changes](Output::Changes outputChanges) {
+        return bool(outputChanges & changes);
+    });
+}
 
-    if (flags & ValidityFlag::RequireAtLeastOneEnabledScreen && enabledOutputsCount == 0) {
-        qCDebug(KSCREEN) << "canBeAppled: There are no enabled screens, at least one required";
-        return false;
-    }
+Output::Changes ConfigChanges::outputChanges(int id) const
+{
+    return changedOutputs.value(id, Output::Change::None);
+}
 
-    const int maxEnabledOutputsCount = config->screen()->maxActiveOutputsCount();
-    if (enabledOutputsCount > maxEnabledOutputsCount) {
-        qCDebug(KSCREEN).nospace() << "canBeApplied: Too many active screens. Requested: " << enabledOutputsCount << ", Max: " << maxEnabledOutputsCount;
-        return false;
-    }
+bool Config::canBeApplied(const ConfigPtr &config)
+{
+    return canBeApplied(config, ValidityFlag::None);
+}
 
-    if (rect.width() > config->screen()->maxSize().width()) {
-        qCDebug(KSCREEN).nospace() << "canBeApplied: The configuration is too wide: " << rect.width() << ", Max: " << config->screen()->maxSize().width();
-        return false;
-    }
-    if (rect.height() > config->screen()->maxSize().height()) {
-        qCDebug(KSCREEN).nospace() << "canBeApplied: The configuration is too high: " << rect.height() << ", Max: " << config->screen()->maxSize().height();
+bool Config::canBeApplied(const ConfigPtr &config, ValidityFlags flags)
+{
+    const ConfigValidation validation = validate(config, flags);
+    if (!validation.isValid()) {
+        qCDebug(KSCREEN) << "canBeApplied:" << validation;
         return false;
     }
-
     return true;
 }
 
+ConfigValidation Config::validate(const ConfigPtr &config, ValidityFlags flags)
+{
+    return ConfigValidator::instance()->validate(config, flags);
+}
+
 Config::Config()
     : QObject(nullptr)
     , d(new Private(this))
@@ -189,10 +241,11 @@ Config::~Config()
 ConfigPtr Config::clone() const
 {
     ConfigPtr newConfig(new Config());
-    newConfig->d->screen = d->screen->clone();
+    newConfig->d->screen = d->screen ? d->screen->clone() : ScreenPtr();
     newConfig->setSupportedFeatures(supportedFeatures());
     newConfig->setTabletModeAvailable(tabletModeAvailable());
     newConfig->setTabletModeEngaged(tabletModeEngaged());
+    newConfig->setSerial(serial());
     for (const OutputPtr &ourOutput : std::as_const(d->outputs)) {
         newConfig->addOutput(ourOutput->clone());
     }
@@ -213,6 +266,21 @@ QString Config::connectedOutputsHash() const
     return QString::fromLatin1(hash.toHex());
 }
 
+quint64 Config::fingerprint(Output::FingerprintScope scope) const
+{
+    QVarLengthArray<quint64, 8> fingerprints;
+    for (const OutputPtr &output : std::as_const(d->outputs)) {
+        if (output->isConnected()) {
+            fingerprints.append(output->fingerprint(scope));
+        }
+    }
+    std::sort(fingerprints.begin(), fingerprints.end());
+
+    Fingerprint fingerprint;
+    fingerprint.add(fingerprints.constData(), fingerprints.size() * sizeof(quint64));
+    return fingerprint.result();
+}
+
 ScreenPtr Config::screen() const
 {
     return d->screen;
@@ -236,6 +304,8 @@ Config::Features Config::supportedFeatures() const
 void Config::setSupportedFeatures(const Config::Features &features)
 {
     d->supportedFeatures = features;
+    // Per-output scaling changes the logical sizes
+    d->invalidateGeometry();
 }
 
 bool Config::tabletModeAvailable() const
@@ -258,6 +328,16 @@ void Config::setTabletModeEngaged(bool engaged)
     d->tabletModeEngaged = engaged;
 }
 
+quint64 Config::serial() const
+{
+    return d->serial;
+}
+
+void Config::setSerial(quint64 serial)
+{
+    d->serial = serial;
+}
+
 OutputList Config::outputs() const
 {
     return d->outputs;
@@ -291,6 +371,23 @@ void Config::addOutput(const OutputPtr &output)
     d->outputs.insert(output->id(), output);
     output->setExplicitLogicalSize(logicalSizeForOutput(*output));
 
+    const auto invalidateGeometry = [this]() {
+        d->invalidateGeometry();
+    };
+    connect(output.data(), &Output::posChanged, this, invalidateGeometry);
+    connect(output.data(), &Output::rotationChanged, this, invalidateGeometry);
+    connect(output.data(), &Output::scaleChanged, this, invalidateGeometry);
+    connect(output.data(), &Output::currentModeIdChanged, this, invalidateGeometry);
+    connect(output.data(), &Output::modesChanged, this, invalidateGeometry);
+    connect(output.data(), &Output::isConnectedChanged, this, invalidateGeometry);
+    connect(output.data(), &Output::isEnabledChanged, this, invalidateGeometry);
+    connect(output.data(), &Output::priorityChanged, this, invalidateGeometry);
+    connect(output.data(), &Output::replicationSourceChanged, this, invalidateGeometry);
+    d->invalidateGeometry();
+    if (d->updateDepth > 0) {
+        output->beginUpdate();
+    }
+
     Q_EMIT outputAdded(output);
 }
 
@@ -355,6 +452,14 @@ static std::optional<OutputPtr> removeOptional(QList<OutputPtr> &haystack, std::
 
 void Config::adjustPriorities(std::optional<OutputPtr> keep)
 {
+    if (d->updateDepth > 0) {
+        d->prioritiesPending = true;
+        if (keep.has_value()) {
+            d->pendingKeep = keep;
+        }
+        return;
+    }
+
     // we need specifically tree-based QMap for this
     QMap<uint32_t, QList<OutputPtr>> multimap;
     uint32_t maxPriority = 0;
@@ -415,6 +520,34 @@ void Config::adjustPriorities(std::optional<OutputPtr> keep)
     Q_EMIT prioritiesChanged();
 }
 
+void Config::beginUpdate()
+{
+    if (d->updateDepth++ > 0) {
+        return;
+    }
+    for (const OutputPtr &output : std::as_const(d->outputs)) {
+        output->beginUpdate();
+    }
+}
+
+void Config::endUpdate()
+{
+    Q_ASSERT(d->updateDepth > 0);
+    if (--d->updateDepth > 0) {
+        return;
+    }
+
+    if (std::exchange(d->prioritiesPending, false)) {
+        adjustPriorities(std::exchange(d->pendingKeep, std::nullopt));
+    }
+
+    // Signal handlers may change the outputs again
+    const OutputList outputs = d->outputs;
+    for (const OutputPtr &output : outputs) {
+        output->endUpdate();
+    }
+}
+
 bool Config::isValid() const
 {
     return d->valid;
@@ -425,30 +558,121 @@ void Config::setValid(bool valid)
     d->valid = valid;
 }
 
-void Config::apply(const ConfigPtr &other)
+ConfigChanges Config::apply(const ConfigPtr &other)
 {
-    d->screen->apply(other->screen());
+    return applyFrom(other, nullptr, ConfigChanges());
+}
 
+QList<ConfigChanges> Config::apply(const QList<ConfigPtr> &configs, const ConfigPtr &other)
+{
+    const auto stateKey = [](const Config &config) {
+        Fingerprint key;
+        key.add(config.d->supportedFeatures.toInt());
+        for (const OutputPtr &output : std::as_const(config.d->outputs)) {
+            key.add(output->id()).add(quintptr(output->stateData()));
+        }
+        return key.result();
+    };
+    // Only what apply() depends on, the other properties are cheap to take over
+    const auto sharesState = [](const Config &a, const Config &b) {
+        if (a.d->supportedFeatures != b.d->supportedFeatures || a.d->outputs.size() != b.d->outputs.size()) {
+            return false;
+        }
+        for (const OutputPtr &output : std::as_const(a.d->outputs)) {
+            const OutputPtr other = b.d->outputs.value(output->id());
+            if (!other || !output->sharesState(*other)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Group the configs in the same state first, applying changes the state
+    QList<qsizetype> leaderOf(configs.size());
+    QMultiHash<quint64, qsizetype> leaders;
+    for (qsizetype i = 0; i < configs.size(); ++i) {
+        const Config &config = *configs.at(i);
+        const quint64 key = stateKey(config);
+        leaderOf[i] = i;
+        for (auto it = leaders.constFind(key); it != leaders.constEnd() && it.key() == key; ++it) {
+            if (sharesState(config, *configs.at(it.value()))) {
+                leaderOf[i] = it.value();
+                break;
+            }
+        }
+        if (leaderOf[i] == i) {
+            leaders.insert(key, i);
+        }
+    }
+
+    QList<ConfigChanges> changes(configs.size());
+    for (qsizetype i = 0; i < configs.size(); ++i) {
+        const qsizetype leader = leaderOf.at(i);
+        if (leader == i) {
+            changes[i] = configs.at(i)->apply(other);
+        } else {
+            changes[i] = configs.at(i)->applyFrom(other, configs.at(leader).data(), changes.at(leader));
+        }
+    }
+    return changes;
+}
+
+ConfigChanges Config::applyFrom(const ConfigPtr &other, const Config *leader, const ConfigChanges &leaderChanges)
+{
+    ConfigChanges changes;
+
+    changes.configChanged = d->propertiesDiffer(*other->d);
+
+    const ScreenPtr &otherScreen = other->d->screen;
+    if (otherScreen && d->screen) {
+        d->screen->apply(otherScreen);
+    } else if (otherScreen) {
+        d->screen = otherScreen->clone();
+    }
+
+    // Before the outputs, their logical size depends on it
+    setSupportedFeatures(other->supportedFeatures());
     setTabletModeAvailable(other->tabletModeAvailable());
     setTabletModeEngaged(other->tabletModeEngaged());
+    setSerial(other->serial());
 
     // Remove removed outputs
     for (auto it = d->outputs.begin(); it != d->outputs.end();) {
         if (!other->d->outputs.contains((*it)->id())) {
+            changes.removedOutputs << (*it)->id();
             it = d->removeOutput(it);
         } else {
             ++it;
         }
     }
 
-    for (const OutputPtr &otherOutput : std::as_const(other->d->outputs)) {
-        // Add new outputs
-        if (!d->outputs.contains(otherOutput->id())) {
-            addOutput(otherOutput->clone());
-        } else {
-            // Update existing outputs
-            d->outputs[otherOutput->id()]->apply(otherOutput);
-            d->outputs[otherOutput->id()]->setExplicitLogicalSize(logicalSizeForOutput(*d->outputs[otherOutput->id()]));
+    if (leader) {
+        // The outputs are the same as those of the leader were, take over what it got
+        for (const OutputPtr &leaderOutput : std::as_const(leader->d->outputs)) {
+            const OutputPtr output = d->outputs.value(leaderOutput->id());
+            if (!output) {
+                addOutput(leaderOutput->clone());
+            } else {
+                output->adoptState(*leaderOutput, leaderChanges.changedOutputs.value(output->id()));
+            }
+        }
+        changes.addedOutputs = leaderChanges.addedOutputs;
+        changes.changedOutputs = leaderChanges.changedOutputs;
+    } else {
+        for (const OutputPtr &otherOutput : std::as_const(other->d->outputs)) {
+            // Add new outputs
+            if (!d->outputs.contains(otherOutput->id())) {
+                changes.addedOutputs << otherOutput->id();
+                addOutput(otherOutput->clone());
+            } else {
+                // Update existing outputs
+                const OutputPtr &output = d->outputs[otherOutput->id()];
+                const Output::Changes outputChanges = output->apply(otherOutput);
+                if (outputChanges) {
+                    changes.changedOutputs.insert(output->id(), outputChanges);
+                }
+                output->setExplicitLogicalSize(logicalSizeForOutput(*output));
+            }
         }
     }
 
@@ -456,6 +680,34 @@ void Config::apply(const ConfigPtr &other)
     setValid(other->isValid());
 
     Q_EMIT prioritiesChanged();
+
+    return changes;
+}
+
+ConfigChanges Config::diff(const ConfigPtr &base) const
+{
+    ConfigChanges changes;
+    if (!base) {
+        changes.addedOutputs = d->outputs.keys();
+        changes.configChanged = true;
+        return changes;
+    }
+
+    changes.configChanged = base->d->propertiesDiffer(*d);
+    for (auto it = base->d->outputs.cbegin(); it != base->d->outputs.cend(); ++it) {
+        if (!d->outputs.contains(it.key())) {
+            changes.removedOutputs << it.key();
+        }
+    }
+    for (auto it = d->outputs.cbegin(); it != d->outputs.cend(); ++it) {
+        const OutputPtr baseOutput = base->d->outputs.value(it.key());
+        if (!baseOutput) {
+            changes.addedOutputs << it.key();
+        } else if (const Output::Changes outputChanges = it.value()->diff(baseOutput)) {
+            changes.changedOutputs.insert(it.key(), outputChanges);
+        }
+    }
+    return changes;
 }
 
 QRect Config::outputGeometryForOutput(const KScreen::Output &output) const
@@ -489,6 +741,156 @@ QSizeF Config::logicalSizeForOutput(const KScreen::Output &output) const
     return size;
 }
 
+OutputPtr Config::outputAt(const QPointF &pos) const
+{
+    const auto &outputs = d->geometryIndex().outputs;
+    const auto it = std::find_if(outputs.cbegin(), outputs.cend(), [&pos](const Private::OutputGeometry &geometry) {
+        return pos.x() >= geometry.rect.x() && pos.x() < geometry.rect.x() + geometry.rect.width()
+            && pos.y() >= geometry.rect.y() && pos.y() < geometry.rect.y() + geometry.rect.height();
+    });
+    return it == outputs.cend() ? OutputPtr() : it->output;
+}
+
+OutputList Config::neighbours(int outputId, Qt::Edge edge) const
+{
+    const auto &outputs = d->geometryIndex().outputs;
+    const auto it = std::find_if(outputs.cbegin(), outputs.cend(), [outputId](const Private::OutputGeometry &geometry) {
+        return geometry.output->id() == outputId;
+    });
+    if (it == outputs.cend()) {
+        return {};
+    }
+
+    // Work with exclusive right and bottom coordinates, so that adjacent outputs share an edge
+    const QRect rect = it->rect;
+    const auto sharesHorizontalSpan = [&rect](const QRect &other) {
+        return other.x() < rect.x() + rect.width() && rect.x() < other.x() + other.width();
+    };
+    const auto sharesVerticalSpan = [&rect](const QRect &other) {
+        return other.y() < rect.y() + rect.height() && rect.y() < other.y() + other.height();
+    };
+
+    OutputList result;
+    for (const Private::OutputGeometry &geometry : outputs) {
+        const QRect &other = geometry.rect;
+        bool touches = false;
+        switch (edge) {
+        case Qt::LeftEdge:
+            touches = other.x() + other.width() == rect.x() && sharesVerticalSpan(other);
+            break;
+        case Qt::RightEdge:
+            touches = other.x() == rect.x() + rect.width() && sharesVerticalSpan(other);
+            break;
+        case Qt::TopEdge:
+            touches = other.y() + other.height() == rect.y() && sharesHorizontalSpan(other);
+            break;
+        case Qt::BottomEdge:
+            touches = other.y() == rect.y() + rect.height() && sharesHorizontalSpan(other);
+            break;
+        }
+        if (touches) {
+            result.insert(geometry.output->id(), geometry.output);
+        }
+    }
+    return result;
+}
+
+bool Config::overlaps() const
+{
+    return d->geometryIndex().overlaps;
+}
+
+QRect Config::boundingRect() const
+{
+    return d->geometryIndex().boundingRect;
+}
+
+bool Config::autoLayout(LayoutPolicy policy)
+{
+    // Columns are laid out as the rows of the transposed layout
+    const bool transpose = policy == LayoutPolicy::Columns;
+    const auto toLayout = [transpose](const QRect &rect) {
+        return transpose ? QRect(rect.y(), rect.x(), rect.height(), rect.width()) : rect;
+    };
+
+    struct Item {
+        OutputPtr output;
+        QRect rect;
+    };
+    QList<Item> items;
+    items.reserve(d->outputs.size());
+    for (const OutputPtr &output : std::as_const(d->outputs)) {
+        if (!output->isConnected() || !output->isEnabled() || output->replicationSource() != 0) {
+            continue;
+        }
+        const QRect rect = outputGeometryForOutput(*output);
+        if (rect.isValid()) {
+            items.append({output, toLayout(rect)});
+        }
+    }
+
+    // The ids make the order total, so the result never depends on the order of d->outputs
+    const auto byPriority = [](const Item &a, const Item &b) {
+        return std::pair(a.output->priority(), a.output->id()) < std::pair(b.output->priority(), b.output->id());
+    };
+    std::sort(items.begin(), items.end(), [&byPriority](const Item &a, const Item &b) {
+        if (a.rect.top() != b.rect.top()) {
+            return a.rect.top() < b.rect.top();
+        }
+        if (a.rect.left() != b.rect.left()) {
+            return a.rect.left() < b.rect.left();
+        }
+        return byPriority(a, b);
+    });
+
+    bool moved = false;
+    beginUpdate();
+    int rowTop = 0;
+    for (qsizetype rowStart = 0; rowStart < items.size();) {
+        // A row is made of the outputs vertically overlapping its topmost one
+        const int rowBottom = items[rowStart].rect.top() + items[rowStart].rect.height();
+        qsizetype rowEnd = rowStart + 1;
+        while (rowEnd < items.size() && items[rowEnd].rect.top() < rowBottom) {
+            ++rowEnd;
+        }
+        std::sort(items.begin() + rowStart, items.begin() + rowEnd, [&byPriority](const Item &a, const Item &b) {
+            if (a.rect.left() != b.rect.left()) {
+                return a.rect.left() < b.rect.left();
+            }
+            return byPriority(a, b);
+        });
+
+        int left = 0;
+        int rowHeight = 0;
+        for (qsizetype i = rowStart; i < rowEnd; ++i) {
+            const QRect rect = items[i].rect;
+            const QPoint pos = transpose ? QPoint(rowTop, left) : QPoint(left, rowTop);
+            if (items[i].output->pos() != pos) {
+                items[i].output->setPos(pos);
+                moved = true;
+            }
+            left += rect.width();
+            rowHeight = std::max(rowHeight, rect.height());
+        }
+        rowTop += rowHeight;
+        rowStart = rowEnd;
+    }
+    endUpdate();
+
+    return moved;
+}
+
+QDebug operator<<(QDebug dbg, const KScreen::ConfigValidation &validation)
+{
+    QDebugStateSaver saver(dbg);
+    dbg.nospace() << "KScreen::ConfigValidation(" << validation.reason;
+    if (validation.outputId != 0) {
+        dbg << ", output " << validation.outputId;
+    }
+    dbg << ")";
+    return dbg;
+}
+
 QDebug operator<<(QDebug dbg, const KScreen::ConfigPtr &config)
 {
     if (config) {
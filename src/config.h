@@ -14,16 +14,91 @@
 #include "types.h"
 
 #include <QHash>
+#include <QList>
+#include <QMap>
 #include <QMetaType>
 #include <QObject>
+#include <QPointF>
+#include <QRect>
 
 #include <cstdint>
 #include <optional>
 
 namespace KScreen
 {
+class ConfigSnapshot;
 class Output;
 
+/**
+ * What Config::apply() changed in a config.
+ *
+ * Listeners that only care about parts of the configuration, e.g. the layout,
+ * can use this to skip updates caused by unrelated properties.
+ *
+ * @since 6.0
+ */
+struct KSCREEN_EXPORT ConfigChanges {
+    /// Ids of the outputs that were added
+    QList<int> addedOutputs;
+    /// Ids of the outputs that were removed
+    QList<int> removedOutputs;
+    /// The properties that changed, for every existing output that changed
+    QMap<int, Output::Changes> changedOutputs;
+    /// Whether the screen, the supported features, the tablet mode state or the validity changed
+    bool configChanged = false;
+
+    bool isEmpty() const;
+
+    /**
+     * @return whether outputs were added or removed, or any output had one
+     * of @p changes
+     */
+    bool affects(Output::Changes changes) const;
+
+    /**
+     * @return the changes of the output with @p id, Output::Change::None if
+     * it did not change
+     */
+    Output::Changes outputChanges(int id) const;
+};
+
+/**
+ * Result of Config::validate(): whether a config can be applied, and if not, why.
+ *
+ * @since 6.0
+ */
+class KSCREEN_EXPORT ConfigValidation
+{
+    Q_GADGET
+
+public:
+    enum class Reason {
+        Valid = 0,
+        NoConfig, ///< the config to check is null
+        NoCurrentConfig, ///< the current config of the system is not known
+        UnknownOutput, ///< an enabled output does not exist in the system
+        OutputDisconnected, ///< an enabled output is not connected
+        NoCurrentMode, ///< an enabled output has no current mode
+        UnknownMode, ///< the current mode of an enabled output is not one the output supports
+        NoEnabledOutput, ///< ValidityFlag::RequireAtLeastOneEnabledScreen was given, but all outputs are disabled
+        TooManyEnabledOutputs, ///< more outputs are enabled than the system can drive at once
+        TooWide, ///< the layout exceeds the maximum screen width
+        TooHigh, ///< the layout exceeds the maximum screen height
+        ReplicationUnsupported, ///< an output replicates another one, but the backend can't do that
+        InvalidReplicationSource, ///< an output replicates one which is not enabled or itself a replica
+    };
+    Q_ENUM(Reason)
+
+    Reason reason = Reason::Valid;
+    /// The output the reason applies to, 0 for config-wide reasons
+    int outputId = 0;
+
+    bool isValid() const
+    {
+        return reason == Reason::Valid;
+    }
+};
+
 /**
  * Represents a (or the) screen configuration.
  *
@@ -69,6 +144,17 @@ public:
     Q_ENUM(Feature)
     Q_DECLARE_FLAGS(Features, Feature)
 
+    /**
+     * How autoLayout() arranges the outputs.
+     *
+     * @since 6.0
+     */
+    enum class LayoutPolicy {
+        Rows, ///< Outputs are placed left to right in rows, the rows top to bottom.
+        Columns, ///< Outputs are placed top to bottom in columns, the columns left to right.
+    };
+    Q_ENUM(LayoutPolicy)
+
     /**
      * Validates that a config can be applied in the current system
      *
@@ -95,6 +181,20 @@ public:
      */
     static bool canBeApplied(const ConfigPtr &config);
 
+    /**
+     * Validates that a config can be applied in the current system, like
+     * canBeApplied(), but tells why it can't.
+     *
+     * The constraints of the system, i.e. the outputs, their modes and the
+     * screen limits of the current config, are collected once and reused until
+     * the current config changes. Results are remembered by the relevant
+     * properties of @p config, so checking the same layout again, e.g. while
+     * the user drags an output back and forth, is a lookup.
+     *
+     * @since 6.0
+     */
+    static ConfigValidation validate(const ConfigPtr &config, ValidityFlags flags = ValidityFlag::None);
+
     /**
      * Instantiate an empty config
      *
@@ -115,6 +215,15 @@ public:
      */
     ConfigPtr clone() const;
 
+    /**
+     * Takes an immutable snapshot of the config, which can be used from other
+     * threads. The snapshot shares the data of the outputs instead of copying
+     * it, use ConfigSnapshot::toConfig() to get a config to apply again.
+     *
+     * @since 6.0
+     */
+    ConfigSnapshot snapshot() const;
+
     /**
      * Returns an identifying hash for this config in regards to its
      * connected outputs.
@@ -127,6 +236,19 @@ public:
      */
     QString connectedOutputsHash() const;
 
+    /**
+     * Returns a 64-bit fingerprint of the connected outputs, independent of
+     * their order and ids.
+     *
+     * With the default scope it identifies the same set of displays as
+     * connectedOutputsHash(), but is much cheaper to compute as it combines the
+     * cached Output::fingerprint() values.
+     *
+     * @see Output::fingerprint
+     * @since 6.0
+     */
+    quint64 fingerprint(Output::FingerprintScope scope = Output::FingerprintScope::Identity) const;
+
     ScreenPtr screen() const;
     void setScreen(const ScreenPtr &screen);
 
@@ -196,10 +318,59 @@ public:
      */
     void adjustPriorities(std::optional<OutputPtr> keep = std::nullopt);
 
+    /**
+     * Starts a batch of changes to the config and its outputs.
+     *
+     * Until the matching endUpdate() the outputs hold back their change
+     * signals, see Output::beginUpdate(), and priorities are not normalized:
+     * adjustPriorities(), setOutputPriority(), setOutputPriorities() and
+     * setOutputs() only remember that it is needed. endUpdate() then runs
+     * adjustPriorities() once, keeping the output of the last request, and
+     * lets every output emit one signal per changed property.
+     *
+     * Calls can be nested, only the outermost endUpdate() commits.
+     *
+     * @see ConfigUpdateGuard
+     * @since 6.0
+     */
+    void beginUpdate();
+
+    /**
+     * Ends a batch of changes started with beginUpdate().
+     * @since 6.0
+     */
+    void endUpdate();
+
     bool isValid() const;
     void setValid(bool valid);
 
-    void apply(const ConfigPtr &other);
+    /**
+     * Updates this config to match @p other, reusing the existing Output objects.
+     *
+     * @return what was changed (since 6.0)
+     */
+    ConfigChanges apply(const ConfigPtr &other);
+
+    /**
+     * Applies @p other to each of @p configs, like apply().
+     *
+     * Configs cloned from the same config and not changed since share their
+     * unchanged values. Such configs are only compared against @p other once,
+     * the others take over the result.
+     *
+     * @return what was changed in each config, in the order of @p configs
+     * @since 6.0
+     */
+    static QList<ConfigChanges> apply(const QList<ConfigPtr> &configs, const ConfigPtr &other);
+
+    /**
+     * Compares this config with @p base, e.g. the config it was created from,
+     * without changing either.
+     *
+     * @return what apply() would change when applying this config to @p base
+     * @since 6.0
+     */
+    ConfigChanges diff(const ConfigPtr &base) const;
 
     /** Indicates features supported by the backend. This exists to allow the user
      * to find out which of the features offered by libkscreen are actually supported
@@ -257,10 +428,82 @@ public:
      */
     void setTabletModeEngaged(bool engaged);
 
+    /**
+     * Identifies the backend state this config was taken from. The backend
+     * launcher increases the serial whenever the configuration changes, so
+     * two configs with the same non-zero serial describe the same state.
+     *
+     * @return the serial, or 0 if unknown, e.g. for configs created by hand
+     * or received from a launcher without support for it
+     * @see setSerial
+     * @since 6.0
+     */
+    quint64 serial() const;
+
+    /**
+     * Sets the serial of the config. This should not be called by the user,
+     * but by the backend.
+     *
+     * @see serial
+     * @since 6.0
+     */
+    void setSerial(quint64 serial);
+
     QRect outputGeometryForOutput(const KScreen::Output &output) const;
 
     QSizeF logicalSizeForOutput(const KScreen::Output &output) const;
 
+    /**
+     * The geometry queries below work on the layout of the enabled outputs,
+     * outputs replicating another one are not part of it. The geometries are
+     * computed once and cached until an output is added, removed, moved,
+     * rotated, scaled or changes its mode.
+     */
+
+    /**
+     * @return the output whose geometry contains @p pos, the one with the
+     * highest priority if several do, or a null pointer
+     * @since 6.0
+     */
+    OutputPtr outputAt(const QPointF &pos) const;
+
+    /**
+     * @return the outputs sharing the given @p edge of the output with
+     * @p outputId, e.g. for Qt::RightEdge the outputs placed directly right
+     * of it. Outputs touching only at a corner are not neighbours.
+     * @since 6.0
+     */
+    OutputList neighbours(int outputId, Qt::Edge edge) const;
+
+    /**
+     * @return whether the geometries of any two outputs overlap
+     * @since 6.0
+     */
+    bool overlaps() const;
+
+    /**
+     * @return the bounding rectangle of all output geometries
+     * @since 6.0
+     */
+    QRect boundingRect() const;
+
+    /**
+     * Moves the enabled outputs so that they neither overlap nor leave gaps,
+     * using their logical sizes.
+     *
+     * Outputs are grouped into rows (or columns) by their current position and
+     * keep their order within them. Outputs at the same position, e.g. ones
+     * that were just connected, are ordered by priority. The layout starts at
+     * the origin. The result only depends on the current positions, sizes and
+     * priorities, so running it again does not move anything.
+     *
+     * Disabled outputs and outputs replicating another one are left alone.
+     *
+     * @return whether any output was moved
+     * @since 6.0
+     */
+    bool autoLayout(LayoutPolicy policy = LayoutPolicy::Rows);
+
 Q_SIGNALS:
     void outputAdded(const KScreen::OutputPtr &output);
     void outputRemoved(int outputId);
@@ -269,14 +512,46 @@ Q_SIGNALS:
 private:
     Q_DISABLE_COPY(Config)
 
+    // apply(), taking over the outputs of @p leader, which was in the same state
+    // as this config before it got @p leaderChanges, if given
+    ConfigChanges applyFrom(const ConfigPtr &other, const Config *leader, const ConfigChanges &leaderChanges);
+
     class Private;
     Private *const d;
 };
 
+/**
+ * Calls Config::beginUpdate() when created and Config::endUpdate() when
+ * destroyed.
+ *
+ * @since 6.0
+ */
+class ConfigUpdateGuard
+{
+public:
+    explicit ConfigUpdateGuard(const ConfigPtr &config)
+        : mConfig(config)
+    {
+        mConfig->beginUpdate();
+    }
+
+    ~ConfigUpdateGuard()
+    {
+        mConfig->endUpdate();
+    }
+
+private:
+    Q_DISABLE_COPY(ConfigUpdateGuard)
+
+    ConfigPtr mConfig;
+};
+
 } // KScreen namespace
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(KScreen::Config::Features)
+Q_DECLARE_METATYPE(KScreen::ConfigChanges)
 
 KSCREEN_EXPORT QDebug operator<<(QDebug dbg, const KScreen::ConfigPtr &config);
+KSCREEN_EXPORT QDebug operator<<(QDebug dbg, const KScreen::ConfigValidation &validation);
 
 #endif // KSCREEN_CONFIG_H
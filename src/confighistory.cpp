@@ -0,0 +1,267 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#include "confighistory.h"
+#include "backendmanager_p.h"
+#include "config.h"
+#include "edid.h"
+#include "kscreen_debug.h"
+#include "output.h"
+#include "screen.h"
+#include "setconfigoperation.h"
+
+#include <algorithm>
+
+using namespace KScreen;
+
+class Q_DECL_HIDDEN ConfigHistory::Private
+{
+public:
+    struct Entry {
+        quint64 generation = 0;
+        ConfigHistory::Origin origin = ConfigHistory::Origin::Manual;
+        quint64 serial = 0;
+        Config::Features supportedFeatures;
+        bool tabletModeAvailable = false;
+        bool tabletModeEngaged = false;
+        bool valid = true;
+        ScreenPtr screen;
+        // Never changed once recorded, so entries can share the outputs that
+        // did not change between them
+        OutputList outputs;
+    };
+
+    const Entry *entry(quint64 generation) const
+    {
+        for (const Entry &entry : entries) {
+            if (entry.generation == generation) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    static bool screensEqual(const ScreenPtr &a, const ScreenPtr &b)
+    {
+        if (!a || !b) {
+            return a == b;
+        }
+        return a->currentSize() == b->currentSize() && a->minSize() == b->minSize() && a->maxSize() == b->maxSize()
+            && a->maxActiveOutputsCount() == b->maxActiveOutputsCount();
+    }
+
+    // Whether @p a and @p b, the outputs with the same id, show the same monitor.
+    // Configs only have EDIDs once they were fetched, which those of change
+    // notifications and replies to SetConfigOperation may not have been yet, so
+    // an output without one can't tell.
+    static bool sameMonitor(const Output &a, const Output &b)
+    {
+        const Edid *edidA = a.edid();
+        const Edid *edidB = b.edid();
+        if (!edidA || !edidB || !edidA->isValid() || !edidB->isValid()) {
+            return true;
+        }
+        return edidA->hash() == edidB->hash();
+    }
+
+    // Output::diff() only covers what Output::apply() reports
+    static bool sameState(const Output &output, const OutputPtr &previous)
+    {
+        return !output.diff(previous) && output.followPreferredMode() == previous->followPreferredMode()
+            && output.explicitLogicalSize() == previous->explicitLogicalSize() && output.size() == previous->size()
+            && output.sizeMm() == previous->sizeMm();
+    }
+
+    static ConfigPtr toConfig(const Entry &entry)
+    {
+        ConfigPtr config(new Config());
+        config->setScreen(entry.screen ? entry.screen->clone() : ScreenPtr());
+        config->setSupportedFeatures(entry.supportedFeatures);
+        config->setTabletModeAvailable(entry.tabletModeAvailable);
+        config->setTabletModeEngaged(entry.tabletModeEngaged);
+        config->setValid(entry.valid);
+        config->setSerial(entry.serial);
+        OutputList outputs;
+        for (const OutputPtr &output : entry.outputs) {
+            outputs.insert(output->id(), output->clone());
+        }
+        config->setOutputs(outputs);
+        return config;
+    }
+
+    void trim()
+    {
+        while (entries.size() > capacity) {
+            entries.removeFirst();
+        }
+    }
+
+    QList<Entry> entries;
+    int capacity = 0;
+    quint64 lastGeneration = 0;
+};
+
+ConfigHistory *ConfigHistory::instance()
+{
+    static ConfigHistory *s_instance = nullptr;
+
+    if (s_instance == nullptr) {
+        s_instance = new ConfigHistory();
+    }
+
+    return s_instance;
+}
+
+ConfigHistory::ConfigHistory()
+    : QObject()
+    , d(new Private)
+{
+}
+
+ConfigHistory::~ConfigHistory()
+{
+    delete d;
+}
+
+int ConfigHistory::capacity() const
+{
+    return d->capacity;
+}
+
+void ConfigHistory::setCapacity(int capacity)
+{
+    d->capacity = std::max(capacity, 0);
+    d->trim();
+}
+
+quint64 ConfigHistory::record(const ConfigPtr &config, Origin origin)
+{
+    if (!config || d->capacity == 0) {
+        return 0;
+    }
+
+    Private::Entry *latest = d->entries.isEmpty() ? nullptr : &d->entries.last();
+
+    Private::Entry entry;
+    entry.origin = origin;
+    entry.serial = config->serial();
+    entry.supportedFeatures = config->supportedFeatures();
+    entry.tabletModeAvailable = config->tabletModeAvailable();
+    entry.tabletModeEngaged = config->tabletModeEngaged();
+    entry.valid = config->isValid();
+
+    const OutputList outputs = config->outputs();
+    bool unchanged = latest && latest->outputs.size() == outputs.size() && latest->supportedFeatures == entry.supportedFeatures
+        && latest->tabletModeAvailable == entry.tabletModeAvailable && latest->tabletModeEngaged == entry.tabletModeEngaged
+        && latest->valid == entry.valid && Private::screensEqual(latest->screen, config->screen());
+
+    if (latest && Private::screensEqual(latest->screen, config->screen())) {
+        entry.screen = latest->screen;
+    } else {
+        entry.screen = config->screen() ? config->screen()->clone() : ScreenPtr();
+    }
+
+    // Whether the latest entry only lacks EDIDs we got since
+    bool edidsFetched = false;
+    for (const OutputPtr &output : outputs) {
+        const OutputPtr previous = latest ? latest->outputs.value(output->id()) : OutputPtr();
+        if (previous && Private::sameMonitor(*previous, *output) && Private::sameState(*output, previous)) {
+            if (output->edid() && !previous->edid()) {
+                entry.outputs.insert(output->id(), output->clone());
+                edidsFetched = true;
+            } else {
+                entry.outputs.insert(output->id(), previous);
+            }
+        } else {
+            entry.outputs.insert(output->id(), output->clone());
+            unchanged = false;
+        }
+    }
+
+    if (unchanged) {
+        if (edidsFetched) {
+            latest->outputs = entry.outputs;
+        }
+        return latest->generation;
+    }
+
+    entry.generation = ++d->lastGeneration;
+    d->entries.append(entry);
+    d->trim();
+    Q_EMIT recorded(entry.generation);
+    return entry.generation;
+}
+
+QList<quint64> ConfigHistory::generations() const
+{
+    QList<quint64> generations;
+    generations.reserve(d->entries.size());
+    for (const Private::Entry &entry : std::as_const(d->entries)) {
+        generations << entry.generation;
+    }
+    return generations;
+}
+
+quint64 ConfigHistory::latestGeneration() const
+{
+    return d->entries.isEmpty() ? 0 : d->entries.last().generation;
+}
+
+ConfigHistory::Origin ConfigHistory::origin(quint64 generation) const
+{
+    const Private::Entry *entry = d->entry(generation);
+    return entry ? entry->origin : Origin::Manual;
+}
+
+ConfigPtr ConfigHistory::config(quint64 generation) const
+{
+    const Private::Entry *entry = d->entry(generation);
+    return entry ? Private::toConfig(*entry) : ConfigPtr();
+}
+
+SetConfigOperation *ConfigHistory::revertTo(quint64 generation)
+{
+    const Private::Entry *entry = d->entry(generation);
+    if (!entry) {
+        qCWarning(KSCREEN) << "No config with generation" << generation << "in the history";
+        return nullptr;
+    }
+
+    // The launcher keeps the library's view of the system up to date, in-process
+    // backends only tell us through the changes we recorded
+    ConfigPtr current;
+    if (BackendManager::instance()->method() == BackendManager::OutOfProcess) {
+        current = BackendManager::instance()->config();
+    }
+    const ConfigPtr target = current ? current->clone() : Private::toConfig(d->entries.last());
+    int reverted = 0;
+    {
+        ConfigUpdateGuard guard(target);
+        const OutputList outputs = target->outputs();
+        for (const OutputPtr &output : outputs) {
+            const OutputPtr previous = entry->outputs.value(output->id());
+            // The same connector may have a different monitor plugged in by now
+            if (!previous || !Private::sameMonitor(*previous, *output)) {
+                continue;
+            }
+            output->apply(previous);
+            ++reverted;
+        }
+    }
+    if (reverted == 0) {
+        qCWarning(KSCREEN) << "No output of config generation" << generation << "is left to revert";
+        return nullptr;
+    }
+
+    qCDebug(KSCREEN) << "Reverting" << reverted << "outputs to config generation" << generation;
+    return new SetConfigOperation(target);
+}
+
+void ConfigHistory::clear()
+{
+    d->entries.clear();
+}
@@ -0,0 +1,126 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#ifndef KSCREEN_CONFIGHISTORY_H
+#define KSCREEN_CONFIGHISTORY_H
+
+#include <QList>
+#include <QObject>
+
+#include "kscreen_export.h"
+#include "types.h"
+
+namespace KScreen
+{
+class SetConfigOperation;
+
+/**
+ * Keeps the last few configurations of the system, e.g. to undo a change or
+ * to revert it unless the user confirms it in time.
+ *
+ * Configs applied with a SetConfigOperation are recorded once the backend
+ * confirmed them, changes reported by ConfigMonitor are recorded as well.
+ * Recording the same state twice in a row only keeps the first entry.
+ *
+ * The entries are immutable and share the data of outputs that did not change
+ * with each other, so keeping many of them is cheap.
+ *
+ * The history is disabled until a capacity is set.
+ *
+ * @since 6.0
+ */
+class KSCREEN_EXPORT ConfigHistory : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Origin {
+        Applied, ///< set by this process through a SetConfigOperation
+        External, ///< reported by the backend, e.g. after a hotplug or another process changed it
+        Manual, ///< passed to record() by the user
+    };
+    Q_ENUM(Origin)
+
+    static ConfigHistory *instance();
+
+    /**
+     * @return the maximum number of entries, 0 if the history is disabled
+     */
+    int capacity() const;
+
+    /**
+     * Sets the maximum number of entries, the oldest ones are dropped when
+     * there are more. A capacity of 0 disables the history and drops all entries.
+     */
+    void setCapacity(int capacity);
+
+    /**
+     * Records the current state of @p config.
+     *
+     * @return the generation of the new entry, or of the latest one if
+     * @p config equals it. 0 if the history is disabled.
+     */
+    quint64 record(const KScreen::ConfigPtr &config, Origin origin = Origin::Manual);
+
+    /**
+     * @return the generations of all entries, oldest first
+     */
+    QList<quint64> generations() const;
+
+    /**
+     * @return the generation of the latest entry, or 0 if there is none
+     */
+    quint64 latestGeneration() const;
+
+    /**
+     * @return how the entry with @p generation was recorded
+     */
+    Origin origin(quint64 generation) const;
+
+    /**
+     * @return a new config with the state of the entry, or a null pointer if
+     * there is no entry with @p generation. The config can be changed freely.
+     */
+    KScreen::ConfigPtr config(quint64 generation) const;
+
+    /**
+     * Applies the state of the entry with @p generation again.
+     *
+     * Only the outputs that still exist are reverted, and only those that
+     * differ from the current config are touched. Outputs connected since
+     * keep their current state, as do outputs that show another monitor by
+     * now, as far as their EDIDs tell.
+     *
+     * @return the started operation, or nullptr if there is no entry with
+     * @p generation or none of its outputs is still there
+     */
+    KScreen::SetConfigOperation *revertTo(quint64 generation);
+
+    /**
+     * Drops all entries.
+     */
+    void clear();
+
+Q_SIGNALS:
+    /**
+     * Emitted when a new entry was added.
+     */
+    void recorded(quint64 generation);
+
+private:
+    explicit ConfigHistory();
+    ~ConfigHistory() override;
+
+    Q_DISABLE_COPY(ConfigHistory)
+
+    class Private;
+    Private *const d;
+};
+
+} /* namespace KScreen */
+
+#endif // KSCREEN_CONFIGHISTORY_H
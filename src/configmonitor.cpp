@@ -8,15 +8,63 @@
 #include "abstractbackend.h"
 #include "backendinterface.h"
 #include "backendmanager_p.h"
+#include "confighistory.h"
 #include "configserializer_p.h"
+#include "edidcache_p.h"
 #include "getconfigoperation.h"
 #include "kscreen_debug.h"
 #include "output.h"
+#include "screen.h"
 
 #include <QDBusPendingCallWatcher>
 
+#include <algorithm>
+
 using namespace KScreen;
 
+namespace
+{
+ConfigMonitor::Interests outputInterestsOf(Output::Changes changes)
+{
+    ConfigMonitor::Interests interests;
+    if (changes.testAnyFlag(Output::Change::Geometry)) {
+        interests |= ConfigMonitor::Interest::Geometry;
+    }
+    if (changes.testAnyFlags(Output::Change::Modes | Output::Change::CurrentMode)) {
+        interests |= ConfigMonitor::Interest::Modes;
+    }
+    if (changes.testAnyFlag(Output::Change::Color)) {
+        interests |= ConfigMonitor::Interest::Color;
+    }
+    if (changes.testAnyFlag(Output::Change::Priority)) {
+        interests |= ConfigMonitor::Interest::Priority;
+    }
+    if (changes.testAnyFlags(Output::Change::Name | Output::Change::Clones | Output::Change::Capabilities)) {
+        interests |= ConfigMonitor::Interest::Other;
+    }
+    return interests;
+}
+
+// Interests of the config-wide properties, which concern every output
+ConfigMonitor::Interests configInterests(const Config &config, const Config &previous)
+{
+    ConfigMonitor::Interests interests;
+    if (config.tabletModeAvailable() != previous.tabletModeAvailable() || config.tabletModeEngaged() != previous.tabletModeEngaged()) {
+        interests |= ConfigMonitor::Interest::TabletMode;
+    }
+    const ScreenPtr screen = config.screen();
+    const ScreenPtr previousScreen = previous.screen();
+    if ((screen ? screen->currentSize() : QSize()) != (previousScreen ? previousScreen->currentSize() : QSize())) {
+        interests |= ConfigMonitor::Interest::Geometry;
+    }
+    if (config.isValid() != previous.isValid() || config.supportedFeatures() != previous.supportedFeatures()
+        || (screen ? screen->maxActiveOutputsCount() : 0) != (previousScreen ? previousScreen->maxActiveOutputsCount() : 0)) {
+        interests |= ConfigMonitor::Interest::Other;
+    }
+    return interests;
+}
+}
+
 class Q_DECL_HIDDEN ConfigMonitor::Private : public QObject
 {
     Q_OBJECT
@@ -25,13 +73,24 @@ public:
     Private(ConfigMonitor *q);
 
     void onBackendReady(org::kde::kscreen::Backend *backend);
-    void backendConfigChanged(const QVariantMap &configMap);
+    void backendConfigReceived();
+    void processConfigChange(const KScreen::ConfigPtr &newConfig);
     void configDestroyed(QObject *removedConfig);
     void getConfigFinished(ConfigOperation *op);
     void updateConfigs(const KScreen::ConfigPtr &newConfig);
     void edidReady(QDBusPendingCallWatcher *watcher);
-
-    QList<QWeakPointer<KScreen::Config>> watchedConfigs;
+    void edidsReady(QDBusPendingCallWatcher *watcher);
+
+    struct Watch {
+        QWeakPointer<KScreen::Config> config;
+        ConfigMonitor::Interests interests = ConfigMonitor::Interest::All;
+        // Any output when empty
+        QList<int> outputIds;
+    };
+    // Keyed by the config, which may already be gone when its destroyed() arrives
+    QHash<const QObject *, Watch> watchedConfigs;
+    // The config of the last update, what the next one is compared with
+    KScreen::ConfigPtr mLastConfig;
 
     QPointer<org::kde::kscreen::Backend> mBackend;
     bool mFirstBackend;
@@ -56,10 +115,6 @@ void ConfigMonitor::Private::onBackendReady(org::kde::kscreen::Backend *backend)
         return;
     }
 
-    if (mBackend) {
-        disconnect(mBackend.data(), &org::kde::kscreen::Backend::configChanged, this, &ConfigMonitor::Private::backendConfigChanged);
-    }
-
     mBackend = QPointer<org::kde::kscreen::Backend>(backend);
     // If we received a new backend interface, then it's very likely that it is
     // because the backend process has crashed - just to be sure we haven't missed
@@ -73,8 +128,6 @@ void ConfigMonitor::Private::onBackendReady(org::kde::kscreen::Backend *backend)
         connect(new GetConfigOperation(), &GetConfigOperation::finished, this, &Private::getConfigFinished);
     }
     mFirstBackend = false;
-
-    connect(mBackend.data(), &org::kde::kscreen::Backend::configChanged, this, &ConfigMonitor::Private::backendConfigChanged);
 }
 
 void ConfigMonitor::Private::getConfigFinished(ConfigOperation *op)
@@ -89,31 +142,57 @@ void ConfigMonitor::Private::getConfigFinished(ConfigOperation *op)
     updateConfigs(config);
 }
 
-void ConfigMonitor::Private::backendConfigChanged(const QVariantMap &configMap)
+void ConfigMonitor::Private::backendConfigReceived()
 {
     Q_ASSERT(BackendManager::instance()->method() == BackendManager::OutOfProcess);
-    ConfigPtr newConfig = ConfigSerializer::deserializeConfig(configMap);
-    if (!newConfig) {
-        qCWarning(KSCREEN) << "Failed to deserialize config from DBus change notification";
+    if (!mBackend) {
+        // Still setting up, the initial config is not a change
+        return;
+    }
+    // BackendManager decodes the change only once somebody asks for it
+    const bool needsConfig = std::any_of(watchedConfigs.cbegin(), watchedConfigs.cend(), [](const Watch &watch) {
+        return !watch.config.isNull();
+    });
+    if (!needsConfig && ConfigHistory::instance()->capacity() == 0) {
+        Q_EMIT q->configurationChanged();
         return;
     }
 
-    const auto connectedOutputs = newConfig->connectedOutputs();
-    for (const OutputPtr &output : connectedOutputs) {
-        if (!output->edid() && output->isConnected()) {
-            QDBusPendingReply<QByteArray> reply = mBackend->getEdid(output->id());
-            mPendingEDIDRequests[newConfig].append(output->id());
-            QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply);
-            watcher->setProperty("outputId", output->id());
-            watcher->setProperty("config", QVariant::fromValue(newConfig));
-            connect(watcher, &QDBusPendingCallWatcher::finished, this, &ConfigMonitor::Private::edidReady);
-        }
+    const ConfigPtr config = BackendManager::instance()->config();
+    if (!config) {
+        qCWarning(KSCREEN) << "Failed to deserialize config from DBus change notification";
+        return;
     }
+    // Shared with everybody else reading it, fetching EDIDs modifies ours
+    processConfigChange(config->clone());
+}
 
-    if (mPendingEDIDRequests.contains(newConfig)) {
-        qCDebug(KSCREEN) << "Requesting missing EDID for outputs" << mPendingEDIDRequests[newConfig];
-    } else {
+void ConfigMonitor::Private::processConfigChange(const KScreen::ConfigPtr &newConfig)
+{
+    // Only monitors plugged in since the last change have to be asked for
+    const QList<int> missingEDIDs = EdidCache::instance()->restore(newConfig);
+
+    if (missingEDIDs.isEmpty()) {
         updateConfigs(newConfig);
+        return;
+    }
+    qCDebug(KSCREEN) << "Requesting missing EDID for outputs" << missingEDIDs;
+
+    // One round-trip for all outputs, a docking station can bring in several at once
+    if (BackendManager::instance()->wireCapabilities() & ConfigSerializer::BatchedEdid) {
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(mBackend->getEdids(missingEDIDs));
+        watcher->setProperty("config", QVariant::fromValue(newConfig));
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, &ConfigMonitor::Private::edidsReady);
+        return;
+    }
+
+    mPendingEDIDRequests[newConfig] = missingEDIDs;
+    for (int outputId : std::as_const(missingEDIDs)) {
+        QDBusPendingReply<QByteArray> reply = mBackend->getEdid(outputId);
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply);
+        watcher->setProperty("outputId", outputId);
+        watcher->setProperty("config", QVariant::fromValue(newConfig));
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, &ConfigMonitor::Private::edidReady);
     }
 }
 
@@ -137,7 +216,7 @@ void ConfigMonitor::Private::edidReady(QDBusPendingCallWatcher *watcher)
         const QByteArray edid = reply.argumentAt<0>();
         if (!edid.isEmpty()) {
             OutputPtr output = config->output(outputId);
-            output->setEdid(edid);
+            EdidCache::instance()->insert(*output, edid);
         }
     }
 
@@ -147,18 +226,86 @@ void ConfigMonitor::Private::edidReady(QDBusPendingCallWatcher *watcher)
     }
 }
 
+void ConfigMonitor::Private::edidsReady(QDBusPendingCallWatcher *watcher)
+{
+    Q_ASSERT(BackendManager::instance()->method() == BackendManager::OutOfProcess);
+
+    const ConfigPtr config = watcher->property("config").value<KScreen::ConfigPtr>();
+    watcher->deleteLater();
+
+    const QDBusPendingReply<QMap<int, QByteArray>> reply = *watcher;
+    if (reply.isError()) {
+        qCWarning(KSCREEN) << "Error when retrieving EDIDs: " << reply.error().message();
+    } else {
+        const QMap<int, QByteArray> edids = reply.value();
+        for (auto it = edids.cbegin(); it != edids.cend(); ++it) {
+            const OutputPtr output = config->output(it.key());
+            if (output && !output->edid()) {
+                EdidCache::instance()->insert(*output, it.value());
+            }
+        }
+    }
+
+    updateConfigs(config);
+}
+
 void ConfigMonitor::Private::updateConfigs(const KScreen::ConfigPtr &newConfig)
 {
-    QMutableListIterator<QWeakPointer<Config>> iter(watchedConfigs);
-    while (iter.hasNext()) {
-        KScreen::ConfigPtr config = iter.next().toStrongRef();
+    ConfigHistory::instance()->record(newConfig, ConfigHistory::Origin::External);
+
+    // What changed since the last update, in terms of what watchers can ask for.
+    // Everything did for the first one.
+    const bool firstUpdate = !mLastConfig;
+    ConfigMonitor::Interests changedInterests = ConfigMonitor::Interest::All;
+    QHash<int, ConfigMonitor::Interests> outputInterests;
+    if (!firstUpdate) {
+        const ConfigChanges changes = newConfig->diff(mLastConfig);
+        changedInterests = configInterests(*newConfig, *mLastConfig);
+        for (int id : std::as_const(changes.addedOutputs)) {
+            outputInterests.insert(id, ConfigMonitor::Interest::All);
+        }
+        for (int id : std::as_const(changes.removedOutputs)) {
+            outputInterests.insert(id, ConfigMonitor::Interest::All);
+        }
+        for (auto it = changes.changedOutputs.cbegin(); it != changes.changedOutputs.cend(); ++it) {
+            outputInterests.insert(it.key(), outputInterestsOf(it.value()));
+        }
+    }
+    // The watched configs may be the one we got, or be changed by their owners
+    mLastConfig = newConfig->clone();
+
+    QList<ConfigPtr> configs;
+    configs.reserve(watchedConfigs.size());
+    for (auto iter = watchedConfigs.begin(); iter != watchedConfigs.end();) {
+        const ConfigPtr config = iter->config.toStrongRef();
         if (!config) {
-            iter.remove();
+            iter = watchedConfigs.erase(iter);
+            continue;
+        }
+        // Unfiltered watchers get every update, even if nothing changed
+        if (iter->interests == ConfigMonitor::Interest::All && iter->outputIds.isEmpty()) {
+            configs << config;
+            ++iter;
             continue;
         }
+        ConfigMonitor::Interests relevant = changedInterests;
+        if (!firstUpdate) {
+            for (auto it = outputInterests.cbegin(); it != outputInterests.cend(); ++it) {
+                if (iter->outputIds.isEmpty() || iter->outputIds.contains(it.key())) {
+                    relevant |= it.value();
+                }
+            }
+        }
+        if (relevant.testAnyFlags(iter->interests)) {
+            configs << config;
+        }
+        ++iter;
+    }
 
-        config->apply(newConfig);
-        iter.setValue(config.toWeakRef());
+    // Clones of the same config get the update together
+    const QList<ConfigChanges> changes = Config::apply(configs, newConfig);
+    for (qsizetype i = 0; i < configs.size(); ++i) {
+        Q_EMIT q->configChanged(configs.at(i), changes.at(i));
     }
 
     Q_EMIT q->configurationChanged();
@@ -166,14 +313,7 @@ void ConfigMonitor::Private::updateConfigs(const KScreen::ConfigPtr &newConfig)
 
 void ConfigMonitor::Private::configDestroyed(QObject *removedConfig)
 {
-    for (auto iter = watchedConfigs.begin(); iter != watchedConfigs.end();) {
-        if (iter->toStrongRef() == removedConfig) {
-            iter = watchedConfigs.erase(iter);
-            // Iterate over the entire list in case there are duplicates
-        } else {
-            ++iter;
-        }
-    }
+    watchedConfigs.remove(removedConfig);
 }
 
 ConfigMonitor *ConfigMonitor::instance()
@@ -193,6 +333,7 @@ ConfigMonitor::ConfigMonitor()
 {
     if (BackendManager::instance()->method() == BackendManager::OutOfProcess) {
         connect(BackendManager::instance(), &BackendManager::backendReady, d, &ConfigMonitor::Private::onBackendReady);
+        connect(BackendManager::instance(), &BackendManager::configReceived, d, &ConfigMonitor::Private::backendConfigReceived);
         BackendManager::instance()->requestBackend();
     }
 }
@@ -204,19 +345,27 @@ ConfigMonitor::~ConfigMonitor()
 
 void ConfigMonitor::addConfig(const ConfigPtr &config)
 {
-    const QWeakPointer<Config> weakConfig = config.toWeakRef();
-    if (!d->watchedConfigs.contains(weakConfig)) {
-        connect(weakConfig.toStrongRef().data(), &QObject::destroyed, d, &Private::configDestroyed);
-        d->watchedConfigs << weakConfig;
+    addConfig(config, Interest::All);
+}
+
+void ConfigMonitor::addConfig(const ConfigPtr &config, Interests interests, const QList<int> &outputIds)
+{
+    if (!config) {
+        return;
+    }
+    auto it = d->watchedConfigs.find(config.data());
+    if (it == d->watchedConfigs.end()) {
+        connect(config.data(), &QObject::destroyed, d, &Private::configDestroyed);
+        it = d->watchedConfigs.insert(config.data(), Private::Watch{config.toWeakRef()});
     }
+    it->interests = interests;
+    it->outputIds = outputIds;
 }
 
 void ConfigMonitor::removeConfig(const ConfigPtr &config)
 {
-    const QWeakPointer<Config> weakConfig = config.toWeakRef();
-    if (d->watchedConfigs.contains(config)) {
-        disconnect(weakConfig.toStrongRef().data(), &QObject::destroyed, d, &Private::configDestroyed);
-        d->watchedConfigs.removeAll(config);
+    if (config && d->watchedConfigs.remove(config.data())) {
+        disconnect(config.data(), &QObject::destroyed, d, &Private::configDestroyed);
     }
 }
 
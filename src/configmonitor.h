@@ -23,14 +23,62 @@ class KSCREEN_EXPORT ConfigMonitor : public QObject
     Q_OBJECT
 
 public:
+    /**
+     * The groups of properties a watched config can be limited to
+     *
+     * @see addConfig()
+     * @since 6.0
+     */
+    enum class Interest {
+        /// Outputs added or removed, their layout (Output::Change::Geometry) or the screen size
+        Geometry = 1 << 0,
+        /// The available modes or the current mode
+        Modes = 1 << 1,
+        /// Output::Change::Color
+        Color = 1 << 2,
+        Priority = 1 << 3,
+        TabletMode = 1 << 4,
+        /// Everything else: names, clones, capabilities, supported features, validity
+        Other = 1 << 5,
+        All = Geometry | Modes | Color | Priority | TabletMode | Other,
+    };
+    Q_ENUM(Interest)
+    Q_DECLARE_FLAGS(Interests, Interest)
+    Q_FLAG(Interests)
+
     static ConfigMonitor *instance();
 
+    /**
+     * Keeps @p config up to date with every change, same as
+     * addConfig(config, Interest::All).
+     */
     void addConfig(const KScreen::ConfigPtr &config);
+
+    /**
+     * Keeps @p config up to date, but only updates it and emits configChanged()
+     * for it when a change touches one of @p interests on one of @p outputIds,
+     * or on any output if @p outputIds is empty. The config catches up with
+     * the changes skipped before on its next update.
+     *
+     * Adding a watched config again replaces its filter.
+     *
+     * @since 6.0
+     */
+    void addConfig(const KScreen::ConfigPtr &config, Interests interests, const QList<int> &outputIds = QList<int>());
     void removeConfig(const KScreen::ConfigPtr &config);
 
 Q_SIGNALS:
     void configurationChanged();
 
+    /**
+     * Emitted for every watched config that was updated, before
+     * configurationChanged(). @p changes describes what was updated, configs
+     * that did not change are reported with an empty change-set.
+     *
+     * @since 6.0
+     */
+    void configChanged(const KScreen::ConfigPtr &config, const KScreen::ConfigChanges &changes);
+
 private:
     explicit ConfigMonitor();
     ~ConfigMonitor() override;
@@ -46,4 +94,6 @@ private:
 
 } /* namespace KScreen */
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(KScreen::ConfigMonitor::Interests)
+
 #endif // KSCREEN_CONFIGMONITOR_H
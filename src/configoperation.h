@@ -26,6 +26,13 @@ public:
     enum Option {
         NoOptions,
         NoEDID,
+        /**
+         * Only transfer the config from the backend if it differs from the one
+         * the library already tracks, see Config::serial(). Has no effect with
+         * backend launchers that do not support it.
+         * @since 6.0
+         */
+        UseCachedConfig = 0x2,
     };
     Q_DECLARE_FLAGS(Options, Option)
 
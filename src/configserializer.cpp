@@ -8,18 +8,29 @@
 #include "configserializer_p.h"
 
 #include "config.h"
+#include "edid.h"
+#include "edidcache_p.h"
 #include "kscreen_debug.h"
 #include "mode.h"
 #include "output.h"
 #include "screen.h"
 
 #include <QDBusArgument>
+#include <QDBusMetaType>
+#include <QDBusVariant>
+#include <QDataStream>
 #include <QFile>
+#include <QHash>
 #include <QJsonDocument>
 #include <QRect>
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <iterator>
 #include <optional>
+#include <string_view>
+#include <type_traits>
 
 using namespace KScreen;
 
@@ -88,8 +99,9 @@ QJsonObject ConfigSerializer::serializeOutput(const OutputPtr &output)
     obj[QLatin1String("replicationSource")] = output->replicationSource();
 
     QJsonArray modes;
-    for (const ModePtr &mode : output->modes()) {
-        modes.append(serializeMode(mode));
+    const QList<ModeInfo> modeInfos = output->modeInfos();
+    for (const ModeInfo &mode : modeInfos) {
+        modes.append(serializeModeInfo(mode));
     }
     obj[QLatin1String("modes")] = modes;
 
@@ -121,13 +133,18 @@ QJsonObject ConfigSerializer::serializeOutput(const OutputPtr &output)
 }
 
 QJsonObject ConfigSerializer::serializeMode(const ModePtr &mode)
+{
+    return serializeModeInfo(mode->info());
+}
+
+QJsonObject ConfigSerializer::serializeModeInfo(const ModeInfo &mode)
 {
     QJsonObject obj;
 
-    obj[QLatin1String("id")] = mode->id();
-    obj[QLatin1String("name")] = mode->name();
-    obj[QLatin1String("size")] = serializeSize(mode->size());
-    obj[QLatin1String("refreshRate")] = mode->refreshRate();
+    obj[QLatin1String("id")] = mode.id;
+    obj[QLatin1String("name")] = mode.name;
+    obj[QLatin1String("size")] = serializeSize(mode.size);
+    obj[QLatin1String("refreshRate")] = mode.refreshRate;
 
     return obj;
 }
@@ -192,45 +209,323 @@ QSize ConfigSerializer::deserializeSize(const QDBusArgument &arg)
     return QSize(w, h);
 }
 
-ConfigPtr ConfigSerializer::deserializeConfig(const QVariantMap &map)
+namespace
 {
-    ConfigPtr config(new Config);
+// What to do with the value of each wire key, one table per map type. The tables
+// are sorted by key, so keys are looked up by binary search rather than by a chain
+// of string comparisons. Handlers return false if the value cannot be used.
+template<typename Target>
+struct KeyHandler {
+    std::string_view key;
+    bool (*apply)(Target &target, const QVariant &value);
+};
 
-    if (map.contains(QLatin1String("features"))) {
-        config->setSupportedFeatures(static_cast<Config::Features>(map[QStringLiteral("features")].toInt()));
-    }
+template<typename Target, size_t N>
+constexpr bool keysSorted(const std::array<KeyHandler<Target>, N> &table)
+{
+    return std::is_sorted(table.begin(), table.end(), [](const KeyHandler<Target> &a, const KeyHandler<Target> &b) {
+        return a.key < b.key;
+    });
+}
 
-    if (map.contains(QLatin1String("tabletModeAvailable"))) {
-        config->setTabletModeAvailable(map[QStringLiteral("tabletModeAvailable")].toBool());
-    }
-    if (map.contains(QLatin1String("tabletModeEngaged"))) {
-        config->setTabletModeEngaged(map[QStringLiteral("tabletModeEngaged")].toBool());
+template<typename Target, size_t N>
+const KeyHandler<Target> *findKeyHandler(const std::array<KeyHandler<Target>, N> &table, const QString &key)
+{
+    const auto latin1 = [](std::string_view key) {
+        return QLatin1String(key.data(), qsizetype(key.size()));
+    };
+    const auto it = std::lower_bound(table.begin(), table.end(), key, [&latin1](const KeyHandler<Target> &handler, const QString &key) {
+        return QString::compare(latin1(handler.key), key) < 0;
+    });
+    if (it == table.end() || latin1(it->key) != key) {
+        return nullptr;
     }
+    return &*it;
+}
 
-    if (map.contains(QLatin1String("outputs"))) {
-        const QDBusArgument &outputsArg = map[QStringLiteral("outputs")].value<QDBusArgument>();
-        outputsArg.beginArray();
-        OutputList outputs;
-        while (!outputsArg.atEnd()) {
-            QVariant value;
-            outputsArg >> value;
-            const KScreen::OutputPtr output = deserializeOutput(value.value<QDBusArgument>());
-            if (!output) {
-                return ConfigPtr();
-            }
-            outputs.insert(output->id(), output);
+constexpr auto s_configKeys = std::to_array<KeyHandler<Config>>({
+    {"features",
+     [](Config &config, const QVariant &value) {
+         config.setSupportedFeatures(static_cast<Config::Features>(value.toInt()));
+         return true;
+     }},
+    {"outputs",
+     [](Config &config, const QVariant &value) {
+         const QDBusArgument &outputsArg = value.value<QDBusArgument>();
+         outputsArg.beginArray();
+         OutputList outputs;
+         while (!outputsArg.atEnd()) {
+             QVariant outputValue;
+             outputsArg >> outputValue;
+             const KScreen::OutputPtr output = ConfigSerializer::deserializeOutput(outputValue.value<QDBusArgument>());
+             if (!output) {
+                 return false;
+             }
+             outputs.insert(output->id(), output);
+         }
+         outputsArg.endArray();
+         config.setOutputs(outputs);
+         return true;
+     }},
+    {"screen",
+     [](Config &config, const QVariant &value) {
+         const KScreen::ScreenPtr screen = ConfigSerializer::deserializeScreen(value.value<QDBusArgument>());
+         if (!screen) {
+             return false;
+         }
+         config.setScreen(screen);
+         return true;
+     }},
+    {"tabletModeAvailable",
+     [](Config &config, const QVariant &value) {
+         config.setTabletModeAvailable(value.toBool());
+         return true;
+     }},
+    {"tabletModeEngaged",
+     [](Config &config, const QVariant &value) {
+         config.setTabletModeEngaged(value.toBool());
+         return true;
+     }},
+});
+static_assert(keysSorted(s_configKeys), "Config keys must be sorted");
+
+constexpr auto s_modeKeys = std::to_array<KeyHandler<ModeInfo>>({
+    {"id",
+     [](ModeInfo &mode, const QVariant &value) {
+         mode.id = value.toString();
+         return true;
+     }},
+    {"name",
+     [](ModeInfo &mode, const QVariant &value) {
+         mode.name = value.toString();
+         return true;
+     }},
+    {"refreshRate",
+     [](ModeInfo &mode, const QVariant &value) {
+         mode.refreshRate = value.toFloat();
+         return true;
+     }},
+    {"size",
+     [](ModeInfo &mode, const QVariant &value) {
+         mode.size = ConfigSerializer::deserializeSize(value.value<QDBusArgument>());
+         return true;
+     }},
+});
+static_assert(keysSorted(s_modeKeys), "Mode keys must be sorted");
+
+bool deserializeModeInfo(const QDBusArgument &arg, ModeInfo &mode)
+{
+    arg.beginMap();
+    while (!arg.atEnd()) {
+        QString key;
+        QVariant value;
+        arg.beginMapEntry();
+        arg >> key >> value;
+        const auto handler = findKeyHandler(s_modeKeys, key);
+        if (!handler) {
+            qCWarning(KSCREEN) << "Invalid key in Mode map: " << key;
+            return false;
         }
-        outputsArg.endArray();
-        config->setOutputs(outputs);
+        handler->apply(mode, value);
+        arg.endMapEntry();
     }
+    arg.endMap();
+    return true;
+}
 
-    if (map.contains(QLatin1String("screen"))) {
-        const QDBusArgument &screenArg = map[QStringLiteral("screen")].value<QDBusArgument>();
-        const KScreen::ScreenPtr screen = deserializeScreen(screenArg);
-        if (!screen) {
+// "primary" and "priority" are resolved once the whole map is read
+struct OutputFields {
+    OutputPtr output;
+    std::optional<bool> primary;
+    std::optional<uint32_t> priority;
+};
+
+constexpr auto s_outputKeys = std::to_array<KeyHandler<OutputFields>>({
+    {"clones",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setClones(ConfigSerializer::deserializeList<int>(value.value<QDBusArgument>()));
+         return true;
+     }},
+    {"connected",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setConnected(value.toBool());
+         return true;
+     }},
+    {"currentModeId",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setCurrentModeId(value.toString());
+         return true;
+     }},
+    {"enabled",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setEnabled(value.toBool());
+         return true;
+     }},
+    {"followPreferredMode",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setFollowPreferredMode(value.toBool());
+         return true;
+     }},
+    {"hdr",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setHdrEnabled(value.toBool());
+         return true;
+     }},
+    {"icon",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setIcon(value.toString());
+         return true;
+     }},
+    {"id",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setId(value.toInt());
+         return true;
+     }},
+    {"modes",
+     [](OutputFields &fields, const QVariant &value) {
+         const QDBusArgument arg = value.value<QDBusArgument>();
+         QList<ModeInfo> modes;
+         arg.beginArray();
+         while (!arg.atEnd()) {
+             QVariant modeValue;
+             arg >> modeValue;
+             ModeInfo mode;
+             if (!deserializeModeInfo(modeValue.value<QDBusArgument>(), mode)) {
+                 return false;
+             }
+             modes << mode;
+         }
+         arg.endArray();
+         fields.output->setModeInfos(modes);
+         return true;
+     }},
+    {"name",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setName(value.toString());
+         return true;
+     }},
+    {"overscan",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setOverscan(value.toUInt());
+         return true;
+     }},
+    {"pos",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setPos(ConfigSerializer::deserializePoint(value.value<QDBusArgument>()));
+         return true;
+     }},
+    {"preferredModes",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setPreferredModes(ConfigSerializer::deserializeList<QString>(value.value<QDBusArgument>()));
+         return true;
+     }},
+    {"primary",
+     [](OutputFields &fields, const QVariant &value) {
+         // primary is deprecated, but if it appears in config for compatibility reason.
+         fields.primary = value.toBool();
+         return true;
+     }},
+    {"priority",
+     [](OutputFields &fields, const QVariant &value) {
+         // "priority" takes precedence over "primary", but we need to
+         //  check it after the loop, otherwise it may come before the
+         //  primary and get overridden.
+         fields.priority = value.toUInt();
+         return true;
+     }},
+    {"replicationSource",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setReplicationSource(value.toInt());
+         return true;
+     }},
+    {"rgbRange",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setRgbRange(static_cast<Output::RgbRange>(value.toInt()));
+         return true;
+     }},
+    {"rotation",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setRotation(static_cast<Output::Rotation>(value.toInt()));
+         return true;
+     }},
+    {"scale",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setScale(value.toDouble());
+         return true;
+     }},
+    {"sdr-brightness",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setSdrBrightness(value.toUInt());
+         return true;
+     }},
+    {"size",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setSize(ConfigSerializer::deserializeSize(value.value<QDBusArgument>()));
+         return true;
+     }},
+    {"sizeMM",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setSizeMm(ConfigSerializer::deserializeSize(value.value<QDBusArgument>()));
+         return true;
+     }},
+    {"type",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setType(static_cast<Output::Type>(value.toInt()));
+         return true;
+     }},
+    {"vrrPolicy",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setVrrPolicy(static_cast<Output::VrrPolicy>(value.toInt()));
+         return true;
+     }},
+    {"wcg",
+     [](OutputFields &fields, const QVariant &value) {
+         fields.output->setWcgEnabled(value.toBool());
+         return true;
+     }},
+});
+static_assert(keysSorted(s_outputKeys), "Output keys must be sorted");
+
+constexpr auto s_screenKeys = std::to_array<KeyHandler<Screen>>({
+    {"currentSize",
+     [](Screen &screen, const QVariant &value) {
+         screen.setCurrentSize(ConfigSerializer::deserializeSize(value.value<QDBusArgument>()));
+         return true;
+     }},
+    {"id",
+     [](Screen &screen, const QVariant &value) {
+         screen.setId(value.toInt());
+         return true;
+     }},
+    {"maxActiveOutputsCount",
+     [](Screen &screen, const QVariant &value) {
+         screen.setMaxActiveOutputsCount(value.toInt());
+         return true;
+     }},
+    {"maxSize",
+     [](Screen &screen, const QVariant &value) {
+         screen.setMaxSize(ConfigSerializer::deserializeSize(value.value<QDBusArgument>()));
+         return true;
+     }},
+    {"minSize",
+     [](Screen &screen, const QVariant &value) {
+         screen.setMinSize(ConfigSerializer::deserializeSize(value.value<QDBusArgument>()));
+         return true;
+     }},
+});
+static_assert(keysSorted(s_screenKeys), "Screen keys must be sorted");
+}
+
+ConfigPtr ConfigSerializer::deserializeConfig(const QVariantMap &map)
+{
+    ConfigPtr config(new Config);
+
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        // Unknown config keys are ignored
+        const auto handler = findKeyHandler(s_configKeys, it.key());
+        if (handler && !handler->apply(*config, it.value())) {
             return ConfigPtr();
         }
-        config->setScreen(screen);
     }
 
     return config;
@@ -238,9 +533,7 @@ ConfigPtr ConfigSerializer::deserializeConfig(const QVariantMap &map)
 
 OutputPtr ConfigSerializer::deserializeOutput(const QDBusArgument &arg)
 {
-    OutputPtr output(new Output);
-    std::optional<bool> primary = std::nullopt;
-    std::optional<uint32_t> priority = std::nullopt;
+    OutputFields fields{OutputPtr(new Output), std::nullopt, std::nullopt};
 
     arg.beginMap();
     while (!arg.atEnd()) {
@@ -248,110 +541,33 @@ OutputPtr ConfigSerializer::deserializeOutput(const QDBusArgument &arg)
         QVariant value;
         arg.beginMapEntry();
         arg >> key >> value;
-        if (key == QLatin1String("id")) {
-            output->setId(value.toInt());
-        } else if (key == QLatin1String("name")) {
-            output->setName(value.toString());
-        } else if (key == QLatin1String("type")) {
-            output->setType(static_cast<Output::Type>(value.toInt()));
-        } else if (key == QLatin1String("icon")) {
-            output->setIcon(value.toString());
-        } else if (key == QLatin1String("pos")) {
-            output->setPos(deserializePoint(value.value<QDBusArgument>()));
-        } else if (key == QLatin1String("scale")) {
-            output->setScale(value.toDouble());
-        } else if (key == QLatin1String("size")) {
-            output->setSize(deserializeSize(value.value<QDBusArgument>()));
-        } else if (key == QLatin1String("rotation")) {
-            output->setRotation(static_cast<Output::Rotation>(value.toInt()));
-        } else if (key == QLatin1String("currentModeId")) {
-            output->setCurrentModeId(value.toString());
-        } else if (key == QLatin1String("preferredModes")) {
-            output->setPreferredModes(deserializeList<QString>(value.value<QDBusArgument>()));
-        } else if (key == QLatin1String("connected")) {
-            output->setConnected(value.toBool());
-        } else if (key == QLatin1String("followPreferredMode")) {
-            output->setFollowPreferredMode(value.toBool());
-        } else if (key == QLatin1String("enabled")) {
-            output->setEnabled(value.toBool());
-        } else if (key == QLatin1String("primary")) {
-            // primary is deprecated, but if it appears in config for compatibility reason.
-            primary = value.toBool();
-        } else if (key == QLatin1String("priority")) {
-            // "priority" takes precedence over "primary", but we need to
-            //  check it after the loop, otherwise it may come before the
-            //  primary and get overridden.
-            priority = value.toUInt();
-        } else if (key == QLatin1String("clones")) {
-            output->setClones(deserializeList<int>(value.value<QDBusArgument>()));
-        } else if (key == QLatin1String("replicationSource")) {
-            output->setReplicationSource(value.toInt());
-        } else if (key == QLatin1String("sizeMM")) {
-            output->setSizeMm(deserializeSize(value.value<QDBusArgument>()));
-        } else if (key == QLatin1String("modes")) {
-            const QDBusArgument arg = value.value<QDBusArgument>();
-            ModeList modes;
-            arg.beginArray();
-            while (!arg.atEnd()) {
-                QVariant value;
-                arg >> value;
-                const KScreen::ModePtr mode = deserializeMode(value.value<QDBusArgument>());
-                if (!mode) {
-                    return OutputPtr();
-                }
-                modes.insert(mode->id(), mode);
-            }
-            arg.endArray();
-            output->setModes(modes);
-        } else if (key == QLatin1String("overscan")) {
-            output->setOverscan(value.toUInt());
-        } else if (key == QLatin1String("vrrPolicy")) {
-            output->setVrrPolicy(static_cast<Output::VrrPolicy>(value.toInt()));
-        } else if (key == QLatin1String("rgbRange")) {
-            output->setRgbRange(static_cast<Output::RgbRange>(value.toInt()));
-        } else {
+        const auto handler = findKeyHandler(s_outputKeys, key);
+        if (!handler) {
             qCWarning(KSCREEN) << "Invalid key in Output map: " << key;
             return OutputPtr();
         }
+        if (!handler->apply(fields, value)) {
+            return OutputPtr();
+        }
         arg.endMapEntry();
     }
     arg.endMap();
-    if (primary.has_value()) {
-        output->setPriority(output->isEnabled() ? (primary.value() ? 1 : 2) : 0);
+    if (fields.primary.has_value()) {
+        fields.output->setPriority(fields.output->isEnabled() ? (fields.primary.value() ? 1 : 2) : 0);
     }
-    if (priority.has_value()) {
-        output->setPriority(priority.value());
+    if (fields.priority.has_value()) {
+        fields.output->setPriority(fields.priority.value());
     }
-    return output;
+    return fields.output;
 }
 
 ModePtr ConfigSerializer::deserializeMode(const QDBusArgument &arg)
 {
-    ModePtr mode(new Mode);
-
-    arg.beginMap();
-    while (!arg.atEnd()) {
-        QString key;
-        QVariant value;
-        arg.beginMapEntry();
-        arg >> key >> value;
-
-        if (key == QLatin1String("id")) {
-            mode->setId(value.toString());
-        } else if (key == QLatin1String("name")) {
-            mode->setName(value.toString());
-        } else if (key == QLatin1String("size")) {
-            mode->setSize(deserializeSize(value.value<QDBusArgument>()));
-        } else if (key == QLatin1String("refreshRate")) {
-            mode->setRefreshRate(value.toFloat());
-        } else {
-            qCWarning(KSCREEN) << "Invalid key in Mode map: " << key;
-            return ModePtr();
-        }
-        arg.endMapEntry();
+    ModeInfo mode;
+    if (!deserializeModeInfo(arg, mode)) {
+        return ModePtr();
     }
-    arg.endMap();
-    return mode;
+    return ModePtr(new Mode(mode));
 }
 
 ScreenPtr ConfigSerializer::deserializeScreen(const QDBusArgument &arg)
@@ -364,22 +580,764 @@ ScreenPtr ConfigSerializer::deserializeScreen(const QDBusArgument &arg)
     while (!arg.atEnd()) {
         arg.beginMapEntry();
         arg >> key >> value;
-        if (key == QLatin1String("id")) {
-            screen->setId(value.toInt());
-        } else if (key == QLatin1String("maxActiveOutputsCount")) {
-            screen->setMaxActiveOutputsCount(value.toInt());
-        } else if (key == QLatin1String("currentSize")) {
-            screen->setCurrentSize(deserializeSize(value.value<QDBusArgument>()));
-        } else if (key == QLatin1String("maxSize")) {
-            screen->setMaxSize(deserializeSize(value.value<QDBusArgument>()));
-        } else if (key == QLatin1String("minSize")) {
-            screen->setMinSize(deserializeSize(value.value<QDBusArgument>()));
-        } else {
+        const auto handler = findKeyHandler(s_screenKeys, key);
+        if (!handler) {
             qCWarning(KSCREEN) << "Invalid key in Screen map:" << key;
             return ScreenPtr();
         }
+        handler->apply(*screen, value);
         arg.endMapEntry();
     }
     arg.endMap();
     return screen;
 }
+
+namespace
+{
+// The JSON serializers turn ints into qlonglong and floats into double, so do the
+// same here. Keys have to be written in QVariantMap order, i.e. sorted.
+void beginDBusMap(QDBusArgument &arg)
+{
+    arg.beginMap(QMetaType::fromType<QString>(), QMetaType::fromType<QDBusVariant>());
+}
+
+template<typename T>
+void writeDBusEntry(QDBusArgument &arg, const QString &key, const T &value)
+{
+    arg.beginMapEntry();
+    arg << key << QDBusVariant(QVariant::fromValue(value));
+    arg.endMapEntry();
+}
+}
+
+void ConfigSerializer::registerDBusTypes()
+{
+    static const bool registered = [] {
+        qDBusRegisterMetaType<DBusConfig>();
+        qDBusRegisterMetaType<DBusOutput>();
+        qDBusRegisterMetaType<DBusOutputList>();
+        qDBusRegisterMetaType<DBusMode>();
+        qDBusRegisterMetaType<DBusModeList>();
+        qDBusRegisterMetaType<DBusScreen>();
+        qDBusRegisterMetaType<DBusPoint>();
+        qDBusRegisterMetaType<DBusSize>();
+        return true;
+    }();
+    Q_UNUSED(registered)
+}
+
+QVariant ConfigSerializer::marshalConfig(const ConfigPtr &config)
+{
+    QDBusArgument arg;
+    arg << DBusConfig{config};
+    return QVariant::fromValue(arg);
+}
+
+QDBusArgument &ConfigSerializer::operator<<(QDBusArgument &arg, const DBusConfig &config)
+{
+    beginDBusMap(arg);
+    // Registration marshals a default constructed value to learn the signature
+    if (config.config) {
+        writeDBusEntry(arg, QStringLiteral("features"), qlonglong(config.config->supportedFeatures().toInt()));
+        writeDBusEntry(arg, QStringLiteral("outputs"), DBusOutputList{config.config->outputs()});
+        if (config.config->screen()) {
+            writeDBusEntry(arg, QStringLiteral("screen"), DBusScreen{config.config->screen()});
+        }
+        writeDBusEntry(arg, QStringLiteral("tabletModeAvailable"), config.config->tabletModeAvailable());
+        writeDBusEntry(arg, QStringLiteral("tabletModeEngaged"), config.config->tabletModeEngaged());
+    }
+    arg.endMap();
+    return arg;
+}
+
+const QDBusArgument &ConfigSerializer::operator>>(const QDBusArgument &arg, DBusConfig &config)
+{
+    QVariantMap map;
+    arg >> map;
+    config.config = deserializeConfig(map);
+    return arg;
+}
+
+QDBusArgument &ConfigSerializer::operator<<(QDBusArgument &arg, const DBusOutput &output)
+{
+    beginDBusMap(arg);
+    if (const OutputPtr &o = output.output) {
+        const Output::Capabilities capabilities = o->capabilities();
+        // Short lists of plain values, a QVariantList is what gives them the "av" signature
+        const QList<int> outputClones = o->clones();
+        QVariantList clones;
+        clones.reserve(outputClones.count());
+        for (int clone : outputClones) {
+            clones << qlonglong(clone);
+        }
+        const QStringList outputPreferredModes = o->preferredModes();
+        const QVariantList preferredModes(outputPreferredModes.cbegin(), outputPreferredModes.cend());
+
+        writeDBusEntry(arg, QStringLiteral("clones"), clones);
+        writeDBusEntry(arg, QStringLiteral("connected"), o->isConnected());
+        writeDBusEntry(arg, QStringLiteral("currentModeId"), o->currentModeId());
+        writeDBusEntry(arg, QStringLiteral("enabled"), o->isEnabled());
+        writeDBusEntry(arg, QStringLiteral("followPreferredMode"), o->followPreferredMode());
+        if (capabilities & Output::Capability::HighDynamicRange) {
+            writeDBusEntry(arg, QStringLiteral("hdr"), o->isHdrEnabled());
+        }
+        writeDBusEntry(arg, QStringLiteral("icon"), o->icon());
+        writeDBusEntry(arg, QStringLiteral("id"), qlonglong(o->id()));
+        writeDBusEntry(arg, QStringLiteral("modes"), DBusModeList{o->modeInfos()});
+        writeDBusEntry(arg, QStringLiteral("name"), o->name());
+        if (capabilities & Output::Capability::Overscan) {
+            writeDBusEntry(arg, QStringLiteral("overscan"), qlonglong(static_cast<int>(o->overscan())));
+        }
+        writeDBusEntry(arg, QStringLiteral("pos"), DBusPoint{o->pos()});
+        writeDBusEntry(arg, QStringLiteral("preferredModes"), preferredModes);
+        writeDBusEntry(arg, QStringLiteral("priority"), qlonglong(static_cast<int>(o->priority())));
+        writeDBusEntry(arg, QStringLiteral("replicationSource"), qlonglong(o->replicationSource()));
+        if (capabilities & Output::Capability::RgbRange) {
+            writeDBusEntry(arg, QStringLiteral("rgbRange"), qlonglong(static_cast<int>(o->rgbRange())));
+        }
+        writeDBusEntry(arg, QStringLiteral("rotation"), qlonglong(static_cast<int>(o->rotation())));
+        writeDBusEntry(arg, QStringLiteral("scale"), double(o->scale()));
+        if (capabilities & Output::Capability::HighDynamicRange) {
+            writeDBusEntry(arg, QStringLiteral("sdr-brightness"), qlonglong(static_cast<int>(o->sdrBrightness())));
+        }
+        writeDBusEntry(arg, QStringLiteral("size"), DBusSize{o->size()});
+        writeDBusEntry(arg, QStringLiteral("sizeMM"), DBusSize{o->sizeMm()});
+        writeDBusEntry(arg, QStringLiteral("type"), qlonglong(static_cast<int>(o->type())));
+        if (capabilities & Output::Capability::Vrr) {
+            writeDBusEntry(arg, QStringLiteral("vrrPolicy"), qlonglong(static_cast<int>(o->vrrPolicy())));
+        }
+        if (capabilities & Output::Capability::WideColorGamut) {
+            writeDBusEntry(arg, QStringLiteral("wcg"), o->isWcgEnabled());
+        }
+    }
+    arg.endMap();
+    return arg;
+}
+
+const QDBusArgument &ConfigSerializer::operator>>(const QDBusArgument &arg, DBusOutput &output)
+{
+    output.output = deserializeOutput(arg);
+    return arg;
+}
+
+QDBusArgument &ConfigSerializer::operator<<(QDBusArgument &arg, const DBusOutputList &outputs)
+{
+    arg.beginArray(QMetaType::fromType<QDBusVariant>());
+    for (const OutputPtr &output : outputs.outputs) {
+        arg << QDBusVariant(QVariant::fromValue(DBusOutput{output}));
+    }
+    arg.endArray();
+    return arg;
+}
+
+const QDBusArgument &ConfigSerializer::operator>>(const QDBusArgument &arg, DBusOutputList &outputs)
+{
+    outputs.outputs.clear();
+    arg.beginArray();
+    while (!arg.atEnd()) {
+        QVariant value;
+        arg >> value;
+        if (const OutputPtr output = deserializeOutput(value.value<QDBusArgument>())) {
+            outputs.outputs.insert(output->id(), output);
+        }
+    }
+    arg.endArray();
+    return arg;
+}
+
+QDBusArgument &ConfigSerializer::operator<<(QDBusArgument &arg, const DBusMode &mode)
+{
+    beginDBusMap(arg);
+    writeDBusEntry(arg, QStringLiteral("id"), mode.mode.id);
+    writeDBusEntry(arg, QStringLiteral("name"), mode.mode.name);
+    writeDBusEntry(arg, QStringLiteral("refreshRate"), double(mode.mode.refreshRate));
+    writeDBusEntry(arg, QStringLiteral("size"), DBusSize{mode.mode.size});
+    arg.endMap();
+    return arg;
+}
+
+const QDBusArgument &ConfigSerializer::operator>>(const QDBusArgument &arg, DBusMode &mode)
+{
+    mode.mode = ModeInfo();
+    deserializeModeInfo(arg, mode.mode);
+    return arg;
+}
+
+QDBusArgument &ConfigSerializer::operator<<(QDBusArgument &arg, const DBusModeList &modes)
+{
+    arg.beginArray(QMetaType::fromType<QDBusVariant>());
+    for (const ModeInfo &mode : modes.modes) {
+        arg << QDBusVariant(QVariant::fromValue(DBusMode{mode}));
+    }
+    arg.endArray();
+    return arg;
+}
+
+const QDBusArgument &ConfigSerializer::operator>>(const QDBusArgument &arg, DBusModeList &modes)
+{
+    modes.modes.clear();
+    arg.beginArray();
+    while (!arg.atEnd()) {
+        QVariant value;
+        arg >> value;
+        ModeInfo mode;
+        if (deserializeModeInfo(value.value<QDBusArgument>(), mode)) {
+            modes.modes << mode;
+        }
+    }
+    arg.endArray();
+    return arg;
+}
+
+QDBusArgument &ConfigSerializer::operator<<(QDBusArgument &arg, const DBusScreen &screen)
+{
+    beginDBusMap(arg);
+    if (screen.screen) {
+        writeDBusEntry(arg, QStringLiteral("currentSize"), DBusSize{screen.screen->currentSize()});
+        writeDBusEntry(arg, QStringLiteral("id"), qlonglong(screen.screen->id()));
+        writeDBusEntry(arg, QStringLiteral("maxActiveOutputsCount"), qlonglong(screen.screen->maxActiveOutputsCount()));
+        writeDBusEntry(arg, QStringLiteral("maxSize"), DBusSize{screen.screen->maxSize()});
+        writeDBusEntry(arg, QStringLiteral("minSize"), DBusSize{screen.screen->minSize()});
+    }
+    arg.endMap();
+    return arg;
+}
+
+const QDBusArgument &ConfigSerializer::operator>>(const QDBusArgument &arg, DBusScreen &screen)
+{
+    screen.screen = deserializeScreen(arg);
+    return arg;
+}
+
+QDBusArgument &ConfigSerializer::operator<<(QDBusArgument &arg, const DBusPoint &point)
+{
+    beginDBusMap(arg);
+    writeDBusEntry(arg, QStringLiteral("x"), qlonglong(point.point.x()));
+    writeDBusEntry(arg, QStringLiteral("y"), qlonglong(point.point.y()));
+    arg.endMap();
+    return arg;
+}
+
+const QDBusArgument &ConfigSerializer::operator>>(const QDBusArgument &arg, DBusPoint &point)
+{
+    point.point = deserializePoint(arg);
+    return arg;
+}
+
+QDBusArgument &ConfigSerializer::operator<<(QDBusArgument &arg, const DBusSize &size)
+{
+    beginDBusMap(arg);
+    writeDBusEntry(arg, QStringLiteral("height"), qlonglong(size.size.height()));
+    writeDBusEntry(arg, QStringLiteral("width"), qlonglong(size.size.width()));
+    arg.endMap();
+    return arg;
+}
+
+const QDBusArgument &ConfigSerializer::operator>>(const QDBusArgument &arg, DBusSize &size)
+{
+    size.size = deserializeSize(arg);
+    return arg;
+}
+
+namespace
+{
+// "KSCB" followed by the format version; bump the version whenever the layout changes
+constexpr quint32 s_binaryMagic = 0x4B534342;
+constexpr quint16 s_binaryVersion = 3;
+// The same layout, but modes are written once to a table in front of the outputs,
+// which refer to them by index. Only sent to clients that negotiated SharedModeTable.
+constexpr quint16 s_binaryModeTableVersion = 4;
+// "KSCD", the same for config deltas
+constexpr quint32 s_deltaMagic = 0x4B534344;
+constexpr quint16 s_deltaVersion = 2;
+
+void writeBinaryMode(QDataStream &stream, const ModeInfo &mode)
+{
+    stream << mode.id << mode.name << mode.size << mode.refreshRate;
+}
+
+ModeInfo readBinaryMode(QDataStream &stream)
+{
+    ModeInfo mode;
+    stream >> mode.id >> mode.name >> mode.size >> mode.refreshRate;
+    return mode;
+}
+
+void writeBinaryModes(QDataStream &stream, const QList<ModeInfo> &modes)
+{
+    stream << quint32(modes.count());
+    for (const ModeInfo &mode : modes) {
+        writeBinaryMode(stream, mode);
+    }
+}
+
+QList<ModeInfo> readBinaryModes(QDataStream &stream)
+{
+    quint32 count = 0;
+    stream >> count;
+
+    QList<ModeInfo> modes;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        modes << readBinaryMode(stream);
+    }
+    return modes;
+}
+
+// Equal modes share one entry of the mode table
+using ModeIndexes = QHash<ModeInfo, quint32>;
+
+// Writes the distinct modes of all outputs and returns where each of them ended up
+ModeIndexes writeBinaryModeTable(QDataStream &stream, const OutputList &outputs)
+{
+    ModeIndexes indexes;
+    QList<ModeInfo> table;
+    for (const OutputPtr &output : outputs) {
+        const QList<ModeInfo> modes = output->modeInfos();
+        for (const ModeInfo &mode : modes) {
+            if (!indexes.contains(mode)) {
+                indexes.insert(mode, quint32(table.count()));
+                table << mode;
+            }
+        }
+    }
+
+    writeBinaryModes(stream, table);
+    return indexes;
+}
+
+void writeBinaryModeRefs(QDataStream &stream, const QList<ModeInfo> &modes, const ModeIndexes &indexes)
+{
+    stream << quint32(modes.count());
+    for (const ModeInfo &mode : modes) {
+        stream << indexes.value(mode);
+    }
+}
+
+struct BinaryModeTable {
+    QList<ModeInfo> modes;
+    // Outputs referring to the same modes, like several panels of one model or
+    // clones, share one list
+    QHash<QList<quint32>, QList<ModeInfo>> lists;
+};
+
+BinaryModeTable readBinaryModeTable(QDataStream &stream)
+{
+    return BinaryModeTable{readBinaryModes(stream), {}};
+}
+
+QList<ModeInfo> readBinaryModeRefs(QDataStream &stream, BinaryModeTable &table)
+{
+    quint32 count = 0;
+    stream >> count;
+
+    QList<quint32> refs;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        quint32 index = 0;
+        stream >> index;
+        if (index >= quint32(table.modes.count())) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            return QList<ModeInfo>();
+        }
+        refs << index;
+    }
+
+    auto it = table.lists.constFind(refs);
+    if (it != table.lists.constEnd()) {
+        return it.value();
+    }
+    QList<ModeInfo> modes;
+    modes.reserve(refs.count());
+    for (quint32 index : std::as_const(refs)) {
+        modes << table.modes.at(index);
+    }
+    table.lists.insert(refs, modes);
+    return modes;
+}
+
+// Describes how one Output property is compared, written and read in the binary
+// format. Full outputs carry all fields in table order, deltas only those whose
+// bit (the index in the table) is set in the output's field mask.
+struct BinaryOutputField {
+    bool (*differs)(const Output &a, const Output &b);
+    void (*write)(QDataStream &stream, const Output &output);
+    void (*read)(QDataStream &stream, Output &output);
+};
+
+#define KSCREEN_BINARY_FIELD(WireType, getter, setter) \
+    BinaryOutputField{ \
+        [](const Output &a, const Output &b) { \
+            return a.getter() != b.getter(); \
+        }, \
+        [](QDataStream &stream, const Output &output) { \
+            stream << static_cast<WireType>(output.getter()); \
+        }, \
+        [](QDataStream &stream, Output &output) { \
+            WireType value{}; \
+            stream >> value; \
+            output.setter(static_cast<std::decay_t<decltype(output.getter())>>(value)); \
+        }, \
+    }
+
+const BinaryOutputField s_binaryOutputFields[] = {
+    KSCREEN_BINARY_FIELD(QString, name, setName),
+    KSCREEN_BINARY_FIELD(qint32, type, setType),
+    KSCREEN_BINARY_FIELD(QString, icon, setIcon),
+    KSCREEN_BINARY_FIELD(QPoint, pos, setPos),
+    KSCREEN_BINARY_FIELD(double, scale, setScale),
+    KSCREEN_BINARY_FIELD(QSize, size, setSize),
+    KSCREEN_BINARY_FIELD(qint32, rotation, setRotation),
+    KSCREEN_BINARY_FIELD(QString, currentModeId, setCurrentModeId),
+    KSCREEN_BINARY_FIELD(QStringList, preferredModes, setPreferredModes),
+    KSCREEN_BINARY_FIELD(bool, isConnected, setConnected),
+    KSCREEN_BINARY_FIELD(bool, followPreferredMode, setFollowPreferredMode),
+    KSCREEN_BINARY_FIELD(bool, isEnabled, setEnabled),
+    KSCREEN_BINARY_FIELD(quint32, priority, setPriority),
+    KSCREEN_BINARY_FIELD(QList<int>, clones, setClones),
+    KSCREEN_BINARY_FIELD(QSize, sizeMm, setSizeMm),
+    KSCREEN_BINARY_FIELD(qint32, replicationSource, setReplicationSource),
+    KSCREEN_BINARY_FIELD(qint32, capabilities, setCapabilities),
+    KSCREEN_BINARY_FIELD(quint32, overscan, setOverscan),
+    KSCREEN_BINARY_FIELD(qint32, vrrPolicy, setVrrPolicy),
+    KSCREEN_BINARY_FIELD(qint32, rgbRange, setRgbRange),
+    KSCREEN_BINARY_FIELD(bool, isHdrEnabled, setHdrEnabled),
+    KSCREEN_BINARY_FIELD(quint32, sdrBrightness, setSdrBrightness),
+    KSCREEN_BINARY_FIELD(bool, isWcgEnabled, setWcgEnabled),
+    BinaryOutputField{
+        [](const Output &a, const Output &b) {
+            return a.modeInfos() != b.modeInfos();
+        },
+        [](QDataStream &stream, const Output &output) {
+            writeBinaryModes(stream, output.modeInfos());
+        },
+        [](QDataStream &stream, Output &output) {
+            output.setModeInfos(readBinaryModes(stream));
+        },
+    },
+};
+
+#undef KSCREEN_BINARY_FIELD
+
+constexpr quint32 s_allOutputFields = (1u << std::size(s_binaryOutputFields)) - 1;
+static_assert(std::size(s_binaryOutputFields) < 32, "Output field mask is 32 bits wide");
+// The modes are the last field, with a mode table they are written as references
+constexpr quint32 s_modesField = 1u << (std::size(s_binaryOutputFields) - 1);
+
+void writeBinaryOutputFields(QDataStream &stream, const Output &output, quint32 fields)
+{
+    for (size_t i = 0; i < std::size(s_binaryOutputFields); ++i) {
+        if (fields & (1u << i)) {
+            s_binaryOutputFields[i].write(stream, output);
+        }
+    }
+}
+
+void readBinaryOutputFields(QDataStream &stream, Output &output, quint32 fields)
+{
+    for (size_t i = 0; i < std::size(s_binaryOutputFields) && stream.status() == QDataStream::Ok; ++i) {
+        if (fields & (1u << i)) {
+            s_binaryOutputFields[i].read(stream, output);
+        }
+    }
+}
+
+quint32 changedOutputFields(const Output &base, const Output &output)
+{
+    quint32 fields = 0;
+    for (size_t i = 0; i < std::size(s_binaryOutputFields); ++i) {
+        if (s_binaryOutputFields[i].differs(base, output)) {
+            fields |= 1u << i;
+        }
+    }
+    return fields;
+}
+
+QByteArray edidHash(const Output &output, const ConfigSerializer::EdidHashes &edidHashes)
+{
+    const Edid *edid = output.edid();
+    if (!edid) {
+        return edidHashes.value(output.id());
+    }
+    return edid->isValid() ? edid->hash().toLatin1() : QByteArray();
+}
+
+// Full outputs carry the hash of their EDID, if known, so that clients can take the
+// EDID from their cache instead of asking the backend for it
+void writeBinaryOutput(QDataStream &stream,
+                       const OutputPtr &output,
+                       const ModeIndexes *modeIndexes = nullptr,
+                       const ConfigSerializer::EdidHashes &edidHashes = ConfigSerializer::EdidHashes())
+{
+    stream << qint32(output->id()) << edidHash(*output, edidHashes);
+    if (modeIndexes) {
+        writeBinaryOutputFields(stream, *output, s_allOutputFields & ~s_modesField);
+        writeBinaryModeRefs(stream, output->modeInfos(), *modeIndexes);
+    } else {
+        writeBinaryOutputFields(stream, *output, s_allOutputFields);
+    }
+}
+
+OutputPtr readBinaryOutput(QDataStream &stream, BinaryModeTable *modeTable = nullptr)
+{
+    qint32 id = 0;
+    QByteArray edidHash;
+    stream >> id >> edidHash;
+
+    OutputPtr output(new Output);
+    output->setId(id);
+    if (modeTable) {
+        readBinaryOutputFields(stream, *output, s_allOutputFields & ~s_modesField);
+        output->setModeInfos(readBinaryModeRefs(stream, *modeTable));
+    } else {
+        readBinaryOutputFields(stream, *output, s_allOutputFields);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return OutputPtr();
+    }
+    if (!edidHash.isEmpty()) {
+        EdidCache::instance()->restore(*output, edidHash);
+    }
+    return output;
+}
+
+bool sameConfigProperties(const ConfigPtr &a, const ConfigPtr &b)
+{
+    if (a->supportedFeatures() != b->supportedFeatures() || a->tabletModeAvailable() != b->tabletModeAvailable()
+        || a->tabletModeEngaged() != b->tabletModeEngaged()) {
+        return false;
+    }
+    const ScreenPtr sa = a->screen();
+    const ScreenPtr sb = b->screen();
+    if (!sa || !sb) {
+        return sa == sb;
+    }
+    return sa->id() == sb->id() && sa->currentSize() == sb->currentSize() && sa->minSize() == sb->minSize() && sa->maxSize() == sb->maxSize()
+        && sa->maxActiveOutputsCount() == sb->maxActiveOutputsCount();
+}
+
+// Config wide properties are small, they are always sent in full
+void writeBinaryConfigProperties(QDataStream &stream, const ConfigPtr &config)
+{
+    stream << qint32(config->supportedFeatures().toInt()) << config->tabletModeAvailable() << config->tabletModeEngaged();
+
+    const ScreenPtr screen = config->screen();
+    stream << !screen.isNull();
+    if (screen) {
+        stream << qint32(screen->id()) << screen->currentSize() << screen->minSize() << screen->maxSize() << qint32(screen->maxActiveOutputsCount());
+    }
+}
+
+void readBinaryConfigProperties(QDataStream &stream, const ConfigPtr &config)
+{
+    qint32 features = 0;
+    bool tabletModeAvailable = false;
+    bool tabletModeEngaged = false;
+    bool hasScreen = false;
+    stream >> features >> tabletModeAvailable >> tabletModeEngaged >> hasScreen;
+
+    config->setSupportedFeatures(static_cast<Config::Features>(features));
+    config->setTabletModeAvailable(tabletModeAvailable);
+    config->setTabletModeEngaged(tabletModeEngaged);
+
+    if (hasScreen) {
+        qint32 id = 0;
+        qint32 maxActiveOutputsCount = 0;
+        QSize currentSize, minSize, maxSize;
+        stream >> id >> currentSize >> minSize >> maxSize >> maxActiveOutputsCount;
+
+        ScreenPtr screen = config->screen();
+        if (!screen) {
+            screen.reset(new Screen);
+            config->setScreen(screen);
+        }
+        screen->setId(id);
+        screen->setCurrentSize(currentSize);
+        screen->setMinSize(minSize);
+        screen->setMaxSize(maxSize);
+        screen->setMaxActiveOutputsCount(maxActiveOutputsCount);
+    }
+}
+}
+
+QByteArray ConfigSerializer::serializeConfigBinary(const ConfigPtr &config, quint64 generation, uint capabilities, const EdidHashes &edidHashes)
+{
+    QByteArray data;
+    if (!config) {
+        return data;
+    }
+
+    const bool modeTable = capabilities & SharedModeTable;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << s_binaryMagic << (modeTable ? s_binaryModeTableVersion : s_binaryVersion) << generation;
+
+    writeBinaryConfigProperties(stream, config);
+
+    const OutputList outputs = config->outputs();
+    std::optional<ModeIndexes> modeIndexes;
+    if (modeTable) {
+        modeIndexes = writeBinaryModeTable(stream, outputs);
+    }
+    stream << quint32(outputs.count());
+    for (const OutputPtr &output : outputs) {
+        writeBinaryOutput(stream, output, modeIndexes ? &*modeIndexes : nullptr, edidHashes);
+    }
+
+    return data;
+}
+
+ConfigPtr ConfigSerializer::deserializeConfigBinary(const QByteArray &data)
+{
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint64 generation = 0;
+    stream >> magic >> version >> generation;
+    if (magic != s_binaryMagic || (version != s_binaryVersion && version != s_binaryModeTableVersion)) {
+        qCWarning(KSCREEN) << "Unknown binary config format, version" << version;
+        return ConfigPtr();
+    }
+
+    ConfigPtr config(new Config);
+    readBinaryConfigProperties(stream, config);
+
+    std::optional<BinaryModeTable> modeTable;
+    if (version == s_binaryModeTableVersion) {
+        modeTable = readBinaryModeTable(stream);
+    }
+
+    quint32 outputCount = 0;
+    stream >> outputCount;
+    OutputList outputs;
+    for (quint32 i = 0; i < outputCount; ++i) {
+        const OutputPtr output = readBinaryOutput(stream, modeTable ? &*modeTable : nullptr);
+        if (!output) {
+            break;
+        }
+        outputs.insert(output->id(), output);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(KSCREEN) << "Truncated binary config";
+        return ConfigPtr();
+    }
+    config->setOutputs(outputs);
+    config->setSerial(generation);
+    return config;
+}
+
+QByteArray ConfigSerializer::serializeConfigDelta(const ConfigPtr &base, const ConfigPtr &config, const EdidHashes &baseEdidHashes, const EdidHashes &edidHashes)
+{
+    if (!base || !config) {
+        return QByteArray();
+    }
+
+    QByteArray outputData;
+    QDataStream outputStream(&outputData, QIODevice::WriteOnly);
+    outputStream.setVersion(QDataStream::Qt_6_0);
+
+    const OutputList baseOutputs = base->outputs();
+    const OutputList outputs = config->outputs();
+
+    QList<int> removed;
+    for (const OutputPtr &output : baseOutputs) {
+        if (!outputs.contains(output->id())) {
+            removed << output->id();
+        }
+    }
+
+    QList<OutputPtr> added;
+    quint32 changedCount = 0;
+    for (const OutputPtr &output : outputs) {
+        const OutputPtr baseOutput = baseOutputs.value(output->id());
+        // A (dis)connected output may be a different monitor now, send it in full so
+        // that clients drop whatever they know about the old one, like its EDID.
+        // Same for a monitor swapped between two notifications.
+        if (!baseOutput || baseOutput->isConnected() != output->isConnected()
+            || edidHash(*baseOutput, baseEdidHashes) != edidHash(*output, edidHashes)) {
+            added << output;
+            continue;
+        }
+        const quint32 fields = changedOutputFields(*baseOutput, *output);
+        if (fields) {
+            outputStream << qint32(output->id()) << fields;
+            writeBinaryOutputFields(outputStream, *output, fields);
+            ++changedCount;
+        }
+    }
+
+    if (removed.isEmpty() && added.isEmpty() && changedCount == 0 && sameConfigProperties(base, config)) {
+        return QByteArray();
+    }
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << s_deltaMagic << s_deltaVersion;
+    writeBinaryConfigProperties(stream, config);
+    stream << removed;
+    stream << quint32(added.count());
+    for (const OutputPtr &output : std::as_const(added)) {
+        writeBinaryOutput(stream, output, nullptr, edidHashes);
+    }
+    stream << changedCount;
+    stream.writeRawData(outputData.constData(), outputData.size());
+
+    return data;
+}
+
+bool ConfigSerializer::applyConfigDelta(const ConfigPtr &config, const QByteArray &delta)
+{
+    QDataStream stream(delta);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if (magic != s_deltaMagic || version != s_deltaVersion) {
+        qCWarning(KSCREEN) << "Unknown config delta format, version" << version;
+        return false;
+    }
+
+    readBinaryConfigProperties(stream, config);
+
+    QList<int> removed;
+    stream >> removed;
+    for (int id : std::as_const(removed)) {
+        config->removeOutput(id);
+    }
+
+    quint32 addedCount = 0;
+    stream >> addedCount;
+    for (quint32 i = 0; i < addedCount; ++i) {
+        const OutputPtr output = readBinaryOutput(stream);
+        if (!output) {
+            qCWarning(KSCREEN) << "Truncated config delta";
+            return false;
+        }
+        // Deltas carry absolute values, so applying one twice is harmless
+        config->removeOutput(output->id());
+        config->addOutput(output);
+    }
+
+    quint32 changedCount = 0;
+    stream >> changedCount;
+    for (quint32 i = 0; i < changedCount; ++i) {
+        qint32 id = 0;
+        quint32 fields = 0;
+        stream >> id >> fields;
+        const OutputPtr output = config->output(id);
+        if (!output) {
+            qCWarning(KSCREEN) << "Config delta refers to unknown output" << id;
+            return false;
+        }
+        readBinaryOutputFields(stream, *output, fields);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(KSCREEN) << "Truncated config delta";
+        return false;
+    }
+    return true;
+}
@@ -9,17 +9,40 @@
 #define CONFIGSERIALIZER_H
 
 #include <QDBusArgument>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QPoint>
+#include <QSize>
 #include <QVariant>
 
 #include "kscreen_export.h"
+#include "mode.h"
 #include "types.h"
 
 namespace KScreen
 {
 namespace ConfigSerializer
 {
+/**
+ * Optional wire format features the client library and the backend launcher
+ * agree on through org.kde.kscreen.Backend.negotiateCapabilities.
+ */
+enum WireCapability : uint {
+    NoWireCapabilities = 0,
+    BinaryConfig = 1 << 0, ///< getConfigV2/setConfigV2/configChangedV2 and configDelta with packed configs
+    BatchedEdid = 1 << 1, ///< getEdids, fetching the EDIDs of several outputs in one call
+    ConditionalConfig = 1 << 2, ///< getConfigIfChanged, skipping the transfer if the client's Config::serial() is current
+    SharedModeTable = 1 << 3, ///< binary configs list every distinct mode once, outputs refer to them by index
+    DeltaSetConfig = 1 << 4, ///< setConfigDelta, sending only the difference to the config at a known generation
+};
+
+/// Wire capabilities implemented by this version of libkscreen
+constexpr uint supportedWireCapabilities = BinaryConfig | BatchedEdid | ConditionalConfig | SharedModeTable | DeltaSetConfig;
+
+/// Edid::hash() by output id, for outputs whose EDID is known but not loaded
+using EdidHashes = QHash<int, QByteArray>;
+
 KSCREEN_EXPORT QJsonObject serializePoint(const QPoint &point);
 KSCREEN_EXPORT QJsonObject serializeSize(const QSize &size);
 template<typename T> KSCREEN_EXPORT QJsonArray serializeList(const QList<T> &list)
@@ -34,6 +57,7 @@ template<typename T> KSCREEN_EXPORT QJsonArray serializeList(const QList<T> &lis
 KSCREEN_EXPORT QJsonObject serializeConfig(const KScreen::ConfigPtr &config);
 KSCREEN_EXPORT QJsonObject serializeOutput(const KScreen::OutputPtr &output);
 KSCREEN_EXPORT QJsonObject serializeMode(const KScreen::ModePtr &mode);
+KSCREEN_EXPORT QJsonObject serializeModeInfo(const KScreen::ModeInfo &mode);
 KSCREEN_EXPORT QJsonObject serializeScreen(const KScreen::ScreenPtr &screen);
 
 KSCREEN_EXPORT QPoint deserializePoint(const QDBusArgument &map);
@@ -55,8 +79,126 @@ KSCREEN_EXPORT KScreen::OutputPtr deserializeOutput(const QDBusArgument &output)
 KSCREEN_EXPORT KScreen::ModePtr deserializeMode(const QDBusArgument &mode);
 KSCREEN_EXPORT KScreen::ScreenPtr deserializeScreen(const QDBusArgument &screen);
 
+/**
+ * Packs the config into a versioned binary blob, as used by the V2 methods
+ * of the backend D-Bus interface.
+ *
+ * @param generation the launcher's config generation the config belongs to,
+ * restored as Config::serial() on the receiving side
+ * @param capabilities the WireCapability flags agreed on with the receiver. With
+ * SharedModeTable, modes are written once per config rather than once per output,
+ * otherwise the blob stays readable by clients which predate the mode table.
+ * @param edidHashes sent for the outputs without an EDID, so that the sender
+ * doesn't have to load the EDIDs into the config
+ */
+KSCREEN_EXPORT QByteArray serializeConfigBinary(const KScreen::ConfigPtr &config,
+                                                quint64 generation = 0,
+                                                uint capabilities = NoWireCapabilities,
+                                                const EdidHashes &edidHashes = EdidHashes());
+/**
+ * Unpacks a blob created by serializeConfigBinary(), with or without mode table.
+ * Outputs which had identical modes share the Mode objects and the ModeList.
+ *
+ * @return the config, or a null pointer if the data is truncated or has an
+ * unknown format version
+ */
+KSCREEN_EXPORT KScreen::ConfigPtr deserializeConfigBinary(const QByteArray &data);
+
+/**
+ * Encodes the difference between @p base and @p config: removed and added
+ * outputs, and the changed properties of the remaining ones. Values are
+ * absolute, so applying a delta to a config that already has some of the
+ * changes is harmless.
+ *
+ * @p baseEdidHashes and @p edidHashes are used like in serializeConfigBinary(),
+ * an output whose EDID changed is sent in full.
+ *
+ * @return the delta, or an empty byte array if the configs do not differ
+ */
+KSCREEN_EXPORT QByteArray serializeConfigDelta(const KScreen::ConfigPtr &base,
+                                               const KScreen::ConfigPtr &config,
+                                               const EdidHashes &baseEdidHashes = EdidHashes(),
+                                               const EdidHashes &edidHashes = EdidHashes());
+/**
+ * Applies a delta created by serializeConfigDelta() to @p config in place.
+ * The caller is responsible for updating the config's serial.
+ *
+ * @return false if the delta is malformed or does not match @p config, in
+ * which case @p config may be partially updated and should be refetched
+ */
+KSCREEN_EXPORT bool applyConfigDelta(const KScreen::ConfigPtr &config, const QByteArray &delta);
+
+/**
+ * Wrappers which marshal straight into a QDBusArgument. They produce exactly the
+ * a{sv} maps of serializeConfig() and friends followed by QJsonObject::toVariantMap(),
+ * without building either of the intermediate trees.
+ *
+ * Put a DBusConfig into a QVariant to send it as a reply or signal argument.
+ * Demarshalling goes through the regular deserializers.
+ */
+struct DBusConfig {
+    KScreen::ConfigPtr config;
+};
+struct DBusOutput {
+    KScreen::OutputPtr output;
+};
+struct DBusOutputList {
+    KScreen::OutputList outputs;
+};
+struct DBusMode {
+    KScreen::ModeInfo mode;
+};
+struct DBusModeList {
+    QList<KScreen::ModeInfo> modes;
+};
+struct DBusScreen {
+    KScreen::ScreenPtr screen;
+};
+struct DBusPoint {
+    QPoint point;
+};
+struct DBusSize {
+    QSize size;
+};
+
+/// Registers the wrappers above with QtDBus, must be called before they are marshalled
+KSCREEN_EXPORT void registerDBusTypes();
+
+/**
+ * @return @p config marshalled once into a QDBusArgument. The variant can be
+ * put into any number of replies and signals, which copy the marshalled data
+ * instead of walking the config again.
+ */
+KSCREEN_EXPORT QVariant marshalConfig(const KScreen::ConfigPtr &config);
+
+KSCREEN_EXPORT QDBusArgument &operator<<(QDBusArgument &arg, const DBusConfig &config);
+KSCREEN_EXPORT const QDBusArgument &operator>>(const QDBusArgument &arg, DBusConfig &config);
+KSCREEN_EXPORT QDBusArgument &operator<<(QDBusArgument &arg, const DBusOutput &output);
+KSCREEN_EXPORT const QDBusArgument &operator>>(const QDBusArgument &arg, DBusOutput &output);
+KSCREEN_EXPORT QDBusArgument &operator<<(QDBusArgument &arg, const DBusOutputList &outputs);
+KSCREEN_EXPORT const QDBusArgument &operator>>(const QDBusArgument &arg, DBusOutputList &outputs);
+KSCREEN_EXPORT QDBusArgument &operator<<(QDBusArgument &arg, const DBusMode &mode);
+KSCREEN_EXPORT const QDBusArgument &operator>>(const QDBusArgument &arg, DBusMode &mode);
+KSCREEN_EXPORT QDBusArgument &operator<<(QDBusArgument &arg, const DBusModeList &modes);
+KSCREEN_EXPORT const QDBusArgument &operator>>(const QDBusArgument &arg, DBusModeList &modes);
+KSCREEN_EXPORT QDBusArgument &operator<<(QDBusArgument &arg, const DBusScreen &screen);
+KSCREEN_EXPORT const QDBusArgument &operator>>(const QDBusArgument &arg, DBusScreen &screen);
+KSCREEN_EXPORT QDBusArgument &operator<<(QDBusArgument &arg, const DBusPoint &point);
+KSCREEN_EXPORT const QDBusArgument &operator>>(const QDBusArgument &arg, DBusPoint &point);
+KSCREEN_EXPORT QDBusArgument &operator<<(QDBusArgument &arg, const DBusSize &size);
+KSCREEN_EXPORT const QDBusArgument &operator>>(const QDBusArgument &arg, DBusSize &size);
+
 }
 
 }
 
+Q_DECLARE_METATYPE(KScreen::ConfigSerializer::DBusConfig)
+Q_DECLARE_METATYPE(KScreen::ConfigSerializer::DBusOutput)
+Q_DECLARE_METATYPE(KScreen::ConfigSerializer::DBusOutputList)
+Q_DECLARE_METATYPE(KScreen::ConfigSerializer::DBusMode)
+Q_DECLARE_METATYPE(KScreen::ConfigSerializer::DBusModeList)
+Q_DECLARE_METATYPE(KScreen::ConfigSerializer::DBusScreen)
+Q_DECLARE_METATYPE(KScreen::ConfigSerializer::DBusPoint)
+Q_DECLARE_METATYPE(KScreen::ConfigSerializer::DBusSize)
+
 #endif // CONFIGSERIALIZER_H
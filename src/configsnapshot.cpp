@@ -0,0 +1,200 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#include "configsnapshot.h"
+
+#include <QMap>
+#include <QSharedData>
+
+namespace KScreen
+{
+class ConfigSnapshotData : public QSharedData
+{
+public:
+    QMap<int, OutputSnapshot> outputs;
+    ScreenInfo screen;
+    bool hasScreen = false;
+    Config::Features supportedFeatures;
+    bool tabletModeAvailable = false;
+    bool tabletModeEngaged = false;
+    bool valid = true;
+    quint64 serial = 0;
+    quint64 identityFingerprint = 0;
+    quint64 stateFingerprint = 0;
+};
+}
+
+using namespace KScreen;
+
+ConfigSnapshot Config::snapshot() const
+{
+    return ConfigSnapshot(*this);
+}
+
+ConfigSnapshot::ConfigSnapshot() = default;
+
+ConfigSnapshot::ConfigSnapshot(const Config &config)
+    : d(new ConfigSnapshotData)
+{
+    const OutputList outputs = config.outputs();
+    for (auto it = outputs.cbegin(); it != outputs.cend(); ++it) {
+        d->outputs.insert(it.key(), it.value()->snapshot());
+    }
+    if (const ScreenPtr screen = config.screen()) {
+        d->screen = screen->info();
+        d->hasScreen = true;
+    }
+    d->supportedFeatures = config.supportedFeatures();
+    d->tabletModeAvailable = config.tabletModeAvailable();
+    d->tabletModeEngaged = config.tabletModeEngaged();
+    d->valid = config.isValid();
+    d->serial = config.serial();
+    // Cheap now that the outputs have cached theirs
+    d->identityFingerprint = config.fingerprint(Output::FingerprintScope::Identity);
+    d->stateFingerprint = config.fingerprint(Output::FingerprintScope::State);
+}
+
+ConfigSnapshot::ConfigSnapshot(const ConfigSnapshot &other) = default;
+
+ConfigSnapshot &ConfigSnapshot::operator=(const ConfigSnapshot &other) = default;
+
+ConfigSnapshot::~ConfigSnapshot() = default;
+
+bool ConfigSnapshot::isNull() const
+{
+    return !d;
+}
+
+ScreenInfo ConfigSnapshot::screen() const
+{
+    return d ? d->screen : ScreenInfo();
+}
+
+QList<OutputSnapshot> ConfigSnapshot::outputs() const
+{
+    return d ? d->outputs.values() : QList<OutputSnapshot>();
+}
+
+QList<OutputSnapshot> ConfigSnapshot::connectedOutputs() const
+{
+    QList<OutputSnapshot> outputs;
+    if (!d) {
+        return outputs;
+    }
+    for (const OutputSnapshot &output : std::as_const(d->outputs)) {
+        if (output.isConnected()) {
+            outputs << output;
+        }
+    }
+    return outputs;
+}
+
+OutputSnapshot ConfigSnapshot::output(int outputId) const
+{
+    return d ? d->outputs.value(outputId) : OutputSnapshot();
+}
+
+OutputSnapshot ConfigSnapshot::primaryOutput() const
+{
+    if (!d) {
+        return OutputSnapshot();
+    }
+    for (const OutputSnapshot &output : std::as_const(d->outputs)) {
+        if (output.isPrimary()) {
+            return output;
+        }
+    }
+    return OutputSnapshot();
+}
+
+Config::Features ConfigSnapshot::supportedFeatures() const
+{
+    return d ? d->supportedFeatures : Config::Features();
+}
+
+bool ConfigSnapshot::tabletModeAvailable() const
+{
+    return d && d->tabletModeAvailable;
+}
+
+bool ConfigSnapshot::tabletModeEngaged() const
+{
+    return d && d->tabletModeEngaged;
+}
+
+bool ConfigSnapshot::isValid() const
+{
+    return d && d->valid;
+}
+
+quint64 ConfigSnapshot::serial() const
+{
+    return d ? d->serial : 0;
+}
+
+QSizeF ConfigSnapshot::logicalSizeForOutput(const OutputSnapshot &output) const
+{
+    QSizeF size = output.enforcedModeSize();
+    if (!size.isValid()) {
+        return QSizeF();
+    }
+    // Same rules as Config::logicalSizeForOutput()
+    if (supportedFeatures().testFlag(Config::Feature::PerOutputScaling)) {
+        size = size / output.scale();
+    }
+    if (!output.isHorizontal()) {
+        size = size.transposed();
+    }
+    return size;
+}
+
+QRect ConfigSnapshot::outputGeometryForOutput(const OutputSnapshot &output) const
+{
+    const QSize size = logicalSizeForOutput(output).toSize();
+    if (!size.isValid()) {
+        return QRect();
+    }
+    return QRect(output.pos(), size);
+}
+
+quint64 ConfigSnapshot::fingerprint(Output::FingerprintScope scope) const
+{
+    if (!d) {
+        return 0;
+    }
+    return scope == Output::FingerprintScope::Identity ? d->identityFingerprint : d->stateFingerprint;
+}
+
+ConfigPtr ConfigSnapshot::toConfig() const
+{
+    if (!d) {
+        return ConfigPtr();
+    }
+
+    ConfigPtr config(new Config());
+    if (d->hasScreen) {
+        ScreenPtr screen(new Screen());
+        screen->setId(d->screen.id);
+        screen->setCurrentSize(d->screen.currentSize);
+        screen->setMinSize(d->screen.minSize);
+        screen->setMaxSize(d->screen.maxSize);
+        screen->setMaxActiveOutputsCount(d->screen.maxActiveOutputsCount);
+        config->setScreen(screen);
+    }
+    config->setSupportedFeatures(d->supportedFeatures);
+    config->setTabletModeAvailable(d->tabletModeAvailable);
+    config->setTabletModeEngaged(d->tabletModeEngaged);
+    config->setValid(d->valid);
+    config->setSerial(d->serial);
+
+    OutputList outputs;
+    for (const OutputSnapshot &output : std::as_const(d->outputs)) {
+        outputs.insert(output.id(), output.toOutput());
+    }
+    config->setOutputs(outputs);
+    return config;
+}
@@ -0,0 +1,187 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#ifndef KSCREEN_CONFIGSNAPSHOT_H
+#define KSCREEN_CONFIGSNAPSHOT_H
+
+#include <QExplicitlySharedDataPointer>
+#include <QList>
+#include <QRect>
+#include <QSizeF>
+
+#include "config.h"
+#include "kscreen_export.h"
+#include "mode.h"
+#include "output.h"
+#include "screen.h"
+#include "types.h"
+
+namespace KScreen
+{
+class OutputSnapshotData;
+class ConfigSnapshotData;
+
+/**
+ * The state of an Output at one point in time.
+ *
+ * Snapshots are immutable values without any QObject, so they can be copied
+ * to and read from any thread. Taking one shares the data of the output
+ * instead of copying it, see Output::snapshot().
+ *
+ * @since 6.0
+ */
+class KSCREEN_EXPORT OutputSnapshot
+{
+public:
+    /**
+     * Creates a null snapshot
+     */
+    OutputSnapshot();
+    OutputSnapshot(const OutputSnapshot &other);
+    OutputSnapshot &operator=(const OutputSnapshot &other);
+    ~OutputSnapshot();
+
+    bool isNull() const;
+
+    int id() const;
+    QString name() const;
+    QString hash() const;
+    Output::Type type() const;
+    QString icon() const;
+    QList<ModeInfo> modeInfos() const;
+    ModeInfo modeInfo(const QString &modeId) const;
+    QString currentModeId() const;
+    QStringList preferredModes() const;
+    QString preferredModeId() const;
+    QPoint pos() const;
+    QSize size() const;
+    QSize enforcedModeSize() const;
+    Output::Rotation rotation() const;
+    bool isHorizontal() const;
+    bool isConnected() const;
+    bool isEnabled() const;
+    bool isPrimary() const;
+    uint32_t priority() const;
+    QList<int> clones() const;
+    int replicationSource() const;
+    bool isPositionable() const;
+    QSize sizeMm() const;
+    QRect geometry() const;
+    qreal scale() const;
+    QSizeF explicitLogicalSize() const;
+    bool followPreferredMode() const;
+    Output::Capabilities capabilities() const;
+    uint32_t overscan() const;
+    Output::VrrPolicy vrrPolicy() const;
+    Output::RgbRange rgbRange() const;
+    bool isHdrEnabled() const;
+    uint32_t sdrBrightness() const;
+    bool isWcgEnabled() const;
+
+    /**
+     * @return the EDID of the output, or nullptr. It is shared by all copies
+     * of the snapshot and can be read from any thread.
+     */
+    const Edid *edid() const;
+
+    /**
+     * @return the fingerprint the output had when the snapshot was taken
+     * @see Output::fingerprint
+     */
+    quint64 fingerprint(Output::FingerprintScope scope = Output::FingerprintScope::Identity) const;
+
+    /**
+     * @return a new output with the state of the snapshot, sharing its data.
+     * The output belongs to the calling thread.
+     */
+    OutputPtr toOutput() const;
+
+private:
+    friend class Output;
+    explicit OutputSnapshot(OutputSnapshotData *dd);
+
+    QExplicitlySharedDataPointer<OutputSnapshotData> d;
+};
+
+/**
+ * The state of a Config at one point in time, for use outside the thread
+ * owning the config, e.g. to compute a layout in a worker thread.
+ *
+ * Snapshots are immutable values without any QObject, so they can be copied
+ * to and read from any thread. Taking one only costs a reference per output,
+ * see Config::snapshot().
+ *
+ * @since 6.0
+ */
+class KSCREEN_EXPORT ConfigSnapshot
+{
+public:
+    /**
+     * Creates a null snapshot
+     */
+    ConfigSnapshot();
+    ConfigSnapshot(const ConfigSnapshot &other);
+    ConfigSnapshot &operator=(const ConfigSnapshot &other);
+    ~ConfigSnapshot();
+
+    bool isNull() const;
+
+    /**
+     * @return the screen of the config, a default constructed ScreenInfo if it had none
+     */
+    ScreenInfo screen() const;
+
+    /**
+     * @return all outputs, sorted by id
+     */
+    QList<OutputSnapshot> outputs() const;
+    QList<OutputSnapshot> connectedOutputs() const;
+
+    /**
+     * @return the output with @p outputId, or a null snapshot
+     */
+    OutputSnapshot output(int outputId) const;
+    OutputSnapshot primaryOutput() const;
+
+    Config::Features supportedFeatures() const;
+    bool tabletModeAvailable() const;
+    bool tabletModeEngaged() const;
+    bool isValid() const;
+    quint64 serial() const;
+
+    /**
+     * @see Config::logicalSizeForOutput
+     */
+    QSizeF logicalSizeForOutput(const OutputSnapshot &output) const;
+
+    /**
+     * @see Config::outputGeometryForOutput
+     */
+    QRect outputGeometryForOutput(const OutputSnapshot &output) const;
+
+    /**
+     * @return the fingerprint the config had when the snapshot was taken
+     * @see Config::fingerprint
+     */
+    quint64 fingerprint(Output::FingerprintScope scope = Output::FingerprintScope::Identity) const;
+
+    /**
+     * @return a new config with the state of the snapshot, e.g. to apply it.
+     * The config and its outputs belong to the calling thread.
+     */
+    ConfigPtr toConfig() const;
+
+private:
+    friend class Config;
+    explicit ConfigSnapshot(const Config &config);
+
+    QExplicitlySharedDataPointer<ConfigSnapshotData> d;
+};
+
+} // KScreen namespace
+
+#endif // KSCREEN_CONFIGSNAPSHOT_H
@@ -0,0 +1,199 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#include "configvalidator_p.h"
+#include "backendmanager_p.h"
+#include "fingerprint_p.h"
+#include "mode.h"
+#include "output.h"
+#include "screen.h"
+
+#include <QRect>
+
+#include <limits>
+
+using namespace KScreen;
+
+// Layout editors check a handful of layouts over and over, this only guards
+// against unbounded growth
+constexpr qsizetype s_maxResults = 256;
+
+ConfigValidator *ConfigValidator::instance()
+{
+    static ConfigValidator s_instance;
+    return &s_instance;
+}
+
+ConfigValidation ConfigValidator::validate(const ConfigPtr &config, Config::ValidityFlags flags)
+{
+    ConfigValidation result;
+    if (!config) {
+        result.reason = ConfigValidation::Reason::NoConfig;
+        return result;
+    }
+    const ConfigPtr current = BackendManager::instance()->config();
+    if (!current) {
+        result.reason = ConfigValidation::Reason::NoCurrentConfig;
+        return result;
+    }
+    updateConstraints(current);
+
+    const quint64 key = resultKey(config, flags);
+    if (const auto it = mResults.constFind(key); it != mResults.cend()) {
+        ++mCacheHits;
+        return it.value();
+    }
+
+    result = check(config, flags);
+    if (mResults.size() >= s_maxResults) {
+        mResults.clear();
+    }
+    mResults.insert(key, result);
+    return result;
+}
+
+void ConfigValidator::clear()
+{
+    mCurrentConfig.clear();
+    mCurrentFingerprint = 0;
+    mOutputs.clear();
+    mResults.clear();
+    mCacheHits = 0;
+}
+
+void ConfigValidator::updateConstraints(const ConfigPtr &current)
+{
+    Fingerprint fingerprint;
+    fingerprint.add(current->serial()).add(current->fingerprint(Output::FingerprintScope::State));
+    if (mCurrentConfig == current && mCurrentFingerprint == fingerprint.result()) {
+        return;
+    }
+
+    mCurrentConfig = current;
+    mCurrentFingerprint = fingerprint.result();
+    mResults.clear();
+
+    mOutputs.clear();
+    const OutputList outputs = current->outputs();
+    for (const OutputPtr &output : outputs) {
+        OutputConstraints &constraints = mOutputs[output->id()];
+        constraints.connected = output->isConnected();
+        const QList<ModeInfo> modes = output->modeInfos();
+        constraints.modes.reserve(modes.size());
+        for (const ModeInfo &mode : modes) {
+            constraints.modes.insert(mode.id);
+        }
+    }
+
+    // Without a screen there are no known limits
+    constexpr int unlimited = std::numeric_limits<int>::max();
+    const ScreenPtr screen = current->screen();
+    mMaxSize = screen ? screen->maxSize() : QSize(unlimited, unlimited);
+    mMaxActiveOutputs = screen ? screen->maxActiveOutputsCount() : unlimited;
+    mReplicationSupported = current->supportedFeatures().testFlag(Config::Feature::OutputReplication);
+}
+
+quint64 ConfigValidator::resultKey(const ConfigPtr &config, Config::ValidityFlags flags)
+{
+    Fingerprint fingerprint;
+    fingerprint.add(flags.toInt());
+    const OutputList outputs = config->outputs();
+    for (const OutputPtr &output : outputs) {
+        // The state fingerprint covers the mode id, but not the size of the mode
+        fingerprint.add(output->id()).add(output->fingerprint(Output::FingerprintScope::State));
+        if (output->isEnabled()) {
+            const QSize size = output->modeInfo(output->currentModeId()).size;
+            fingerprint.add(size.width()).add(size.height());
+        }
+    }
+    return fingerprint.result();
+}
+
+ConfigValidation ConfigValidator::check(const ConfigPtr &config, Config::ValidityFlags flags) const
+{
+    ConfigValidation result;
+    const auto reject = [&result](ConfigValidation::Reason reason, int outputId = 0) {
+        result.reason = reason;
+        result.outputId = outputId;
+        return result;
+    };
+
+    QRect rect;
+    const OutputList outputs = config->outputs();
+    int enabledOutputsCount = 0;
+    for (const OutputPtr &output : outputs) {
+        if (!output->isEnabled()) {
+            continue;
+        }
+
+        ++enabledOutputsCount;
+
+        const auto constraints = mOutputs.constFind(output->id());
+        if (constraints == mOutputs.cend()) {
+            return reject(ConfigValidation::Reason::UnknownOutput, output->id());
+        }
+        if (!constraints->connected) {
+            return reject(ConfigValidation::Reason::OutputDisconnected, output->id());
+        }
+        if (output->currentModeId().isEmpty()) {
+            return reject(ConfigValidation::Reason::NoCurrentMode, output->id());
+        }
+        if (!constraints->modes.contains(output->currentModeId())) {
+            return reject(ConfigValidation::Reason::UnknownMode, output->id());
+        }
+
+        if (const int source = output->replicationSource(); source != 0) {
+            if (!mReplicationSupported) {
+                return reject(ConfigValidation::Reason::ReplicationUnsupported, output->id());
+            }
+            const OutputPtr sourceOutput = outputs.value(source);
+            if (!sourceOutput || !sourceOutput->isEnabled() || sourceOutput->replicationSource() != 0) {
+                return reject(ConfigValidation::Reason::InvalidReplicationSource, output->id());
+            }
+        }
+
+        const QSize outputSize = output->modeInfo(output->currentModeId()).size;
+
+        if (output->pos().x() < rect.x()) {
+            rect.setX(output->pos().x());
+        }
+
+        if (output->pos().y() < rect.y()) {
+            rect.setY(output->pos().y());
+        }
+
+        QPoint bottomRight;
+        if (output->isHorizontal()) {
+            bottomRight = QPoint(output->pos().x() + outputSize.width(), output->pos().y() + outputSize.height());
+        } else {
+            bottomRight = QPoint(output->pos().x() + outputSize.height(), output->pos().y() + outputSize.width());
+        }
+
+        if (bottomRight.x() > rect.width()) {
+            rect.setWidth(bottomRight.x());
+        }
+
+        if (bottomRight.y() > rect.height()) {
+            rect.setHeight(bottomRight.y());
+        }
+    }
+
+    if (flags & Config::ValidityFlag::RequireAtLeastOneEnabledScreen && enabledOutputsCount == 0) {
+        return reject(ConfigValidation::Reason::NoEnabledOutput);
+    }
+    if (enabledOutputsCount > mMaxActiveOutputs) {
+        return reject(ConfigValidation::Reason::TooManyEnabledOutputs);
+    }
+    if (rect.width() > mMaxSize.width()) {
+        return reject(ConfigValidation::Reason::TooWide);
+    }
+    if (rect.height() > mMaxSize.height()) {
+        return reject(ConfigValidation::Reason::TooHigh);
+    }
+
+    return result;
+}
@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#ifndef KSCREEN_CONFIGVALIDATOR_P_H
+#define KSCREEN_CONFIGVALIDATOR_P_H
+
+#include <QHash>
+#include <QSet>
+#include <QSize>
+#include <QWeakPointer>
+
+#include "config.h"
+#include "kscreen_export.h"
+
+namespace KScreen
+{
+/**
+ * Backs Config::validate(). Keeps the constraints of the current config and
+ * the results of recent checks, both are dropped when the current config
+ * changes.
+ */
+class KSCREEN_EXPORT ConfigValidator
+{
+public:
+    static ConfigValidator *instance();
+
+    ConfigValidation validate(const ConfigPtr &config, Config::ValidityFlags flags);
+
+    void clear();
+
+    // For tests and debugging
+    quint64 cacheHits() const
+    {
+        return mCacheHits;
+    }
+
+private:
+    ConfigValidator() = default;
+    Q_DISABLE_COPY(ConfigValidator)
+
+    struct OutputConstraints {
+        bool connected = false;
+        QSet<QString> modes;
+    };
+
+    // Makes sure the constraints are those of @p current
+    void updateConstraints(const ConfigPtr &current);
+    ConfigValidation check(const ConfigPtr &config, Config::ValidityFlags flags) const;
+    // Covers everything check() looks at in @p config
+    static quint64 resultKey(const ConfigPtr &config, Config::ValidityFlags flags);
+
+    QWeakPointer<Config> mCurrentConfig;
+    quint64 mCurrentFingerprint = 0;
+    QHash<int, OutputConstraints> mOutputs;
+    QSize mMaxSize;
+    int mMaxActiveOutputs = 0;
+    bool mReplicationSupported = false;
+
+    QHash<quint64, ConfigValidation> mResults;
+    quint64 mCacheHits = 0;
+};
+
+}
+
+#endif // KSCREEN_CONFIGVALIDATOR_P_H
@@ -73,7 +73,7 @@ void Doctor::start(QCommandLineParser *parser)
         showBackends();
     }
     if (parser->isSet(QStringLiteral("json")) || parser->isSet(QStringLiteral("outputs")) || !m_outputArgs.isEmpty()) {
-        KScreen::GetConfigOperation *op = new KScreen::GetConfigOperation();
+        KScreen::GetConfigOperation *op = new KScreen::GetConfigOperation(KScreen::GetConfigOperation::UseCachedConfig);
         connect(op, &KScreen::GetConfigOperation::finished, this, [this](KScreen::ConfigOperation *op) {
             configReceived(op);
         });
@@ -33,7 +33,7 @@
 
 using namespace KScreen;
 
-class Q_DECL_HIDDEN Edid::Private
+class Q_DECL_HIDDEN Edid::Private : public QSharedData
 {
 public:
     Private()
@@ -97,20 +97,18 @@ Edid::Edid(const QByteArray &data, QObject *parent)
     d->parse(data);
 }
 
-Edid::Edid(Edid::Private *dd)
+Edid::Edid(const QSharedDataPointer<Edid::Private> &dd)
     : QObject()
     , d(dd)
 {
 }
 
-Edid::~Edid()
-{
-    delete d;
-}
+Edid::~Edid() = default;
 
 Edid *Edid::clone() const
 {
-    return new Edid(new Private(*d));
+    // The parsed data never changes, the clone shares it
+    return new Edid(d);
 }
 
 bool Edid::isValid() const
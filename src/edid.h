@@ -12,6 +12,7 @@
 
 #include <QObject>
 #include <QQuaternion>
+#include <QSharedDataPointer>
 #include <QtGlobal>
 
 namespace KScreen
@@ -62,9 +63,9 @@ private:
     Q_DISABLE_COPY(Edid)
 
     class Private;
-    Private *const d;
+    QSharedDataPointer<Private> d;
 
-    explicit Edid(Private *dd);
+    explicit Edid(const QSharedDataPointer<Private> &dd);
 };
 
 }
@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#include "edidcache_p.h"
+#include "config.h"
+#include "edid.h"
+#include "kscreen_debug.h"
+#include "output.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+using namespace KScreen;
+
+// Per index; more monitors than that are rarely seen by one session
+constexpr qsizetype s_maxEntries = 64;
+
+EdidCache *EdidCache::instance()
+{
+    static EdidCache s_instance;
+    return &s_instance;
+}
+
+template<typename Key>
+void EdidCache::touch(QHash<Key, Entry> &entries, const Key &key, const QSharedPointer<Edid> &edid)
+{
+    Entry &entry = entries[key];
+    entry.edid = edid;
+    entry.lastUse = ++mLastUse;
+
+    if (entries.size() <= s_maxEntries) {
+        return;
+    }
+    auto oldest = std::min_element(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.lastUse < b.lastUse;
+    });
+    entries.erase(oldest);
+}
+
+quint64 EdidCache::generation(const Output &output)
+{
+    Connection &connection = mConnections[output.id()];
+    if (output.isConnected() && !connection.connected) {
+        connection.generation = ++mLastGeneration;
+    }
+    connection.connected = output.isConnected();
+    return connection.generation;
+}
+
+QSharedPointer<Edid> EdidCache::parse(const QByteArray &edidData)
+{
+    if (edidData.isEmpty()) {
+        return {};
+    }
+
+    QSharedPointer<Edid> edid(new Edid(edidData));
+    if (!edid->isValid()) {
+        return {};
+    }
+    const QByteArray hash = edid->hash().toLatin1();
+    // Parsed before, keep sharing the first one
+    if (const auto it = mByHash.constFind(hash); it != mByHash.constEnd()) {
+        edid = it->edid;
+    }
+    touch(mByHash, hash, edid);
+    return edid;
+}
+
+bool EdidCache::restore(Output &output, const QByteArray &hash)
+{
+    // Misses are counted once the output turns out to need a fetch
+    const auto it = mByHash.constFind(hash);
+    if (it == mByHash.constEnd()) {
+        // The backend knows better than the connection generation, which only
+        // changes if we saw the output disconnected
+        for (auto identity = mByIdentity.begin(); identity != mByIdentity.end();) {
+            if (identity.key().first == output.id()) {
+                identity = mByIdentity.erase(identity);
+            } else {
+                ++identity;
+            }
+        }
+        return false;
+    }
+    ++mHits;
+    const QSharedPointer<Edid> edid = it->edid;
+    touch(mByHash, hash, edid);
+    if (!output.edid()) {
+        output.adoptEdid(edid->clone());
+    }
+    touch(mByIdentity, IdentityKey(output.id(), generation(output)), edid);
+    return true;
+}
+
+QList<int> EdidCache::restore(const ConfigPtr &config)
+{
+    QList<int> missing;
+    if (!config) {
+        return missing;
+    }
+
+    QSet<int> seen;
+    const OutputList outputs = config->outputs();
+    for (const OutputPtr &output : outputs) {
+        seen.insert(output->id());
+        const quint64 generation = this->generation(*output);
+        if (!output->isConnected()) {
+            continue;
+        }
+
+        if (output->edid()) {
+            // Completed by its hash while deserializing
+            continue;
+        }
+        const IdentityKey key(output->id(), generation);
+        const auto it = mByIdentity.constFind(key);
+        if (it == mByIdentity.constEnd()) {
+            ++mMisses;
+            missing << output->id();
+            continue;
+        }
+        ++mHits;
+        const QSharedPointer<Edid> edid = it->edid;
+        touch(mByIdentity, key, edid);
+        output->adoptEdid(edid->clone());
+    }
+
+    // Outputs that are gone count as disconnected
+    for (auto it = mConnections.begin(); it != mConnections.end();) {
+        if (!seen.contains(it.key())) {
+            it = mConnections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    qCDebug(KSCREEN) << "EDID cache:" << mHits << "hits," << mMisses << "misses, missing" << missing;
+    return missing;
+}
+
+void EdidCache::insert(const QByteArray &edidData)
+{
+    parse(edidData);
+}
+
+void EdidCache::insert(Output &output, const QByteArray &edidData)
+{
+    const QSharedPointer<Edid> edid = parse(edidData);
+    if (!edid) {
+        // Still give it to the output, it knows how to deal with bad data
+        if (!output.edid()) {
+            output.setEdid(edidData);
+        }
+        return;
+    }
+    touch(mByIdentity, IdentityKey(output.id(), generation(output)), edid);
+    if (!output.edid()) {
+        output.adoptEdid(edid->clone());
+    }
+}
+
+void EdidCache::forgetConnections()
+{
+    mByIdentity.clear();
+    mConnections.clear();
+}
+
+void EdidCache::clear()
+{
+    mByHash.clear();
+    mByIdentity.clear();
+    mConnections.clear();
+    mHits = 0;
+    mMisses = 0;
+}
+
+quint64 EdidCache::hits() const
+{
+    return mHits;
+}
+
+quint64 EdidCache::misses() const
+{
+    return mMisses;
+}
+
+qsizetype EdidCache::size() const
+{
+    return mByIdentity.size();
+}
@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#ifndef KSCREEN_EDIDCACHE_P_H
+#define KSCREEN_EDIDCACHE_P_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+
+#include <utility>
+
+#include "kscreen_export.h"
+#include "types.h"
+
+namespace KScreen
+{
+class Edid;
+
+/**
+ * Process-wide store of the EDIDs received from the backend, parsed once and
+ * shared by all outputs showing the same monitor.
+ *
+ * EDIDs are found either by their Edid::hash(), which binary configs carry for
+ * every output, or by the output id and the connection generation: the
+ * generation of an output changes every time it is seen connected after having
+ * been disconnected or gone, so a monitor plugged into the same connector
+ * again is fetched from the backend instead of taking the EDID of the previous
+ * one. Both indexes only keep the most recently used entries.
+ *
+ * The generations are only right if the cache sees every config. When changes
+ * went by unseen, forgetConnections() has to be called. That includes every
+ * config received as a map, as the launcher may have coalesced an unplug and
+ * a replug into one change.
+ */
+class KSCREEN_EXPORT EdidCache
+{
+public:
+    static EdidCache *instance();
+
+    /**
+     * Gives @p output the EDID with the given hash, if it is known. Otherwise
+     * the output has another monitor than the cache remembers for it, which
+     * restore() will then ask to fetch.
+     *
+     * @return whether the output has an EDID now
+     */
+    bool restore(Output &output, const QByteArray &hash);
+
+    /**
+     * Updates the connection generations from @p config and gives each
+     * connected output without an EDID the one it had in its current
+     * generation.
+     *
+     * @return the ids of the connected outputs whose EDID has to be fetched
+     */
+    QList<int> restore(const ConfigPtr &config);
+
+    /**
+     * Remembers @p edidData. Invalid EDIDs have no hash and are ignored.
+     */
+    void insert(const QByteArray &edidData);
+
+    /**
+     * Remembers @p edidData as the EDID of @p output in its current connection
+     * generation and gives it to the output, unless it already has one.
+     */
+    void insert(Output &output, const QByteArray &edidData);
+
+    /**
+     * Treats all outputs as newly connected, so that restore() no longer gives
+     * them the EDID they had before. Found by hash still works.
+     */
+    void forgetConnections();
+
+    void clear();
+
+    // For tests and debugging: EDIDs served from the cache, EDIDs that had to be fetched
+    quint64 hits() const;
+    quint64 misses() const;
+    qsizetype size() const;
+
+private:
+    EdidCache() = default;
+    Q_DISABLE_COPY(EdidCache)
+
+    struct Entry {
+        QSharedPointer<Edid> edid;
+        quint64 lastUse = 0;
+    };
+    struct Connection {
+        bool connected = false;
+        quint64 generation = 0;
+    };
+    using IdentityKey = std::pair<int, quint64>;
+
+    quint64 generation(const Output &output);
+    QSharedPointer<Edid> parse(const QByteArray &edidData);
+    template<typename Key>
+    void touch(QHash<Key, Entry> &entries, const Key &key, const QSharedPointer<Edid> &edid);
+
+    QHash<QByteArray, Entry> mByHash;
+    QHash<IdentityKey, Entry> mByIdentity;
+    QHash<int, Connection> mConnections;
+    quint64 mLastGeneration = 0;
+    quint64 mLastUse = 0;
+    quint64 mHits = 0;
+    quint64 mMisses = 0;
+};
+
+}
+
+#endif // KSCREEN_EDIDCACHE_P_H
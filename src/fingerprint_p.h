@@ -0,0 +1,70 @@
+/*
+ * SPDX-FileCopyrightText: 2026 libkscreen contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#ifndef KSCREEN_FINGERPRINT_P_H
+#define KSCREEN_FINGERPRINT_P_H
+
+#include <QStringView>
+
+#include <cstddef>
+#include <type_traits>
+
+namespace KScreen
+{
+/**
+ * Builds a 64-bit FNV-1a hash over the added values.
+ *
+ * Unlike qHash() the result does not depend on a per-process seed or on the
+ * Qt version, so fingerprints can be stored and compared across sessions.
+ * It is not suited to resist deliberate collisions.
+ */
+class Fingerprint
+{
+public:
+    Fingerprint &add(const void *data, std::size_t size)
+    {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            mHash ^= bytes[i];
+            mHash *= Q_UINT64_C(0x100000001b3);
+        }
+        return *this;
+    }
+
+    Fingerprint &add(QStringView string)
+    {
+        // The length keeps consecutive strings from running into each other
+        add(qint64(string.size()));
+        return add(string.utf16(), string.size() * sizeof(char16_t));
+    }
+
+    template<typename T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+    Fingerprint &add(T value)
+    {
+        return add(&value, sizeof(value));
+    }
+
+    quint64 result() const
+    {
+        // Spread the bits of the last bytes over the whole value
+        quint64 hash = mHash;
+        hash ^= hash >> 33;
+        hash *= Q_UINT64_C(0xff51afd7ed558ccd);
+        hash ^= hash >> 33;
+        hash *= Q_UINT64_C(0xc4ceb9fe1a85ec53);
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+private:
+    quint64 mHash = Q_UINT64_C(0xcbf29ce484222325);
+};
+
+}
+
+#endif // KSCREEN_FINGERPRINT_P_H
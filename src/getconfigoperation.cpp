@@ -11,6 +11,7 @@
 #include "config.h"
 #include "configoperation_p.h"
 #include "configserializer_p.h"
+#include "edidcache_p.h"
 #include "log.h"
 #include "output.h"
 
@@ -28,6 +29,7 @@ public:
     void backendReady(org::kde::kscreen::Backend *backend) override;
     void onConfigReceived(QDBusPendingCallWatcher *watcher);
     void onEDIDReceived(QDBusPendingCallWatcher *watcher);
+    void onEDIDsReceived(QDBusPendingCallWatcher *watcher);
 
 public:
     GetConfigOperation::Options options;
@@ -36,6 +38,9 @@ public:
     void loadEdid(KScreen::AbstractBackend *backend);
 
     // For out-of-process
+    bool binaryConfig = false;
+    // The config we asked the backend to confirm with getConfigIfChanged()
+    ConfigPtr cachedConfig;
     int pendingEDIDs;
     QPointer<org::kde::kscreen::Backend> mBackend;
 
@@ -65,7 +70,20 @@ void GetConfigOperationPrivate::backendReady(org::kde::kscreen::Backend *backend
     }
 
     mBackend = backend;
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(mBackend->getConfig(), this);
+    const uint wireCapabilities = BackendManager::instance()->wireCapabilities();
+    binaryConfig = wireCapabilities & ConfigSerializer::BinaryConfig;
+
+    if (options & GetConfigOperation::UseCachedConfig && wireCapabilities & ConfigSerializer::ConditionalConfig) {
+        cachedConfig = BackendManager::instance()->config();
+        if (cachedConfig && cachedConfig->serial() != 0) {
+            QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(mBackend->getConfigIfChanged(cachedConfig->serial()), this);
+            connect(watcher, &QDBusPendingCallWatcher::finished, this, &GetConfigOperationPrivate::onConfigReceived);
+            return;
+        }
+        cachedConfig.clear();
+    }
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(binaryConfig ? QDBusPendingCall(mBackend->getConfigV2()) : mBackend->getConfig(), this);
     connect(watcher, &QDBusPendingCallWatcher::finished, this, &GetConfigOperationPrivate::onConfigReceived);
 }
 
@@ -74,15 +92,28 @@ void GetConfigOperationPrivate::onConfigReceived(QDBusPendingCallWatcher *watche
     Q_ASSERT(BackendManager::instance()->method() == BackendManager::OutOfProcess);
     Q_Q(GetConfigOperation);
 
-    QDBusPendingReply<QVariantMap> reply = *watcher;
     watcher->deleteLater();
-    if (reply.isError()) {
-        q->setError(reply.error().message());
+    if (watcher->isError()) {
+        q->setError(watcher->error().message());
         q->emitResult();
         return;
     }
 
-    config = ConfigSerializer::deserializeConfig(reply.value());
+    if (binaryConfig) {
+        const QDBusPendingReply<QByteArray> reply = *watcher;
+        if (cachedConfig && reply.value().isEmpty()) {
+            // Unchanged, callers may modify what they get, so hand out a copy
+            config = cachedConfig->clone();
+        } else {
+            config = ConfigSerializer::deserializeConfigBinary(reply.value());
+        }
+    } else {
+        const QDBusPendingReply<QVariantMap> reply = *watcher;
+        // Without EDID hashes, outputs that seem to have stayed connected may show
+        // another monitor by now, see BackendManager::decodePendingConfig()
+        EdidCache::instance()->forgetConnections();
+        config = ConfigSerializer::deserializeConfig(reply.value());
+    }
     if (!config) {
         q->setError(tr("Failed to deserialize backend response"));
         q->emitResult();
@@ -100,14 +131,23 @@ void GetConfigOperationPrivate::onConfigReceived(QDBusPendingCallWatcher *watche
         q->emitResult();
         return;
     }
-    const auto outputs = config->outputs();
-    for (const OutputPtr &output : outputs) {
-        if (!output->isConnected()) {
-            continue;
-        }
+    // Outputs whose EDID hash was in the binary config, or that stayed connected
+    // since their EDID was fetched, already have it from the cache
+    const QList<int> missingEDIDs = EdidCache::instance()->restore(config);
+    if (missingEDIDs.isEmpty()) {
+        q->emitResult();
+        return;
+    }
+
+    if (BackendManager::instance()->wireCapabilities() & ConfigSerializer::BatchedEdid) {
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(mBackend->getEdids(missingEDIDs), this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, &GetConfigOperationPrivate::onEDIDsReceived);
+        return;
+    }
 
-        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(mBackend->getEdid(output->id()), this);
-        watcher->setProperty("outputId", output->id());
+    for (int outputId : std::as_const(missingEDIDs)) {
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(mBackend->getEdid(outputId), this);
+        watcher->setProperty("outputId", outputId);
         connect(watcher, &QDBusPendingCallWatcher::finished, this, &GetConfigOperationPrivate::onEDIDReceived);
         ++pendingEDIDs;
     }
@@ -129,12 +169,35 @@ void GetConfigOperationPrivate::onEDIDReceived(QDBusPendingCallWatcher *watcher)
     const QByteArray edidData = reply.value();
     const int outputId = watcher->property("outputId").toInt();
 
-    config->output(outputId)->setEdid(edidData);
+    EdidCache::instance()->insert(*config->output(outputId), edidData);
     if (--pendingEDIDs == 0) {
         q->emitResult();
     }
 }
 
+void GetConfigOperationPrivate::onEDIDsReceived(QDBusPendingCallWatcher *watcher)
+{
+    Q_ASSERT(BackendManager::instance()->method() == BackendManager::OutOfProcess);
+    Q_Q(GetConfigOperation);
+
+    const QDBusPendingReply<QMap<int, QByteArray>> reply = *watcher;
+    watcher->deleteLater();
+    if (reply.isError()) {
+        q->setError(reply.error().message());
+        q->emitResult();
+        return;
+    }
+
+    const QMap<int, QByteArray> edids = reply.value();
+    for (auto it = edids.cbegin(); it != edids.cend(); ++it) {
+        const OutputPtr output = config->output(it.key());
+        if (output && !output->edid()) {
+            EdidCache::instance()->insert(*output, it.value());
+        }
+    }
+    q->emitResult();
+}
+
 GetConfigOperation::GetConfigOperation(Options options, QObject *parent)
     : ConfigOperation(new GetConfigOperationPrivate(options, this), parent)
 {
@@ -8,7 +8,7 @@
 #include "mode.h"
 
 using namespace KScreen;
-class Q_DECL_HIDDEN Mode::Private
+class Q_DECL_HIDDEN Mode::Private : public QSharedData
 {
 public:
     Private()
@@ -36,20 +36,33 @@ Mode::Mode()
 {
 }
 
-Mode::Mode(Mode::Private *dd)
+Mode::Mode(const ModeInfo &info)
+    : QObject(nullptr)
+    , d(new Private())
+{
+    d->id = info.id;
+    d->name = info.name;
+    d->size = info.size;
+    d->rate = info.refreshRate;
+}
+
+Mode::Mode(const QSharedDataPointer<Mode::Private> &dd)
     : QObject()
     , d(dd)
 {
 }
 
-Mode::~Mode()
+Mode::~Mode() = default;
+
+ModePtr Mode::clone() const
 {
-    delete d;
+    // The clone shares the data until one of them changes
+    return ModePtr(new Mode(d));
 }
 
-ModePtr Mode::clone() const
+ModeInfo Mode::info() const
 {
-    return ModePtr(new Mode(new Private(*d)));
+    return ModeInfo{d->id, d->name, d->size, d->rate};
 }
 
 const QString Mode::id() const
@@ -59,7 +72,7 @@ const QString Mode::id() const
 
 void Mode::setId(const QString &id)
 {
-    if (d->id == id) {
+    if (d.constData()->id == id) {
         return;
     }
 
@@ -75,7 +88,7 @@ QString Mode::name() const
 
 void Mode::setName(const QString &name)
 {
-    if (d->name == name) {
+    if (d.constData()->name == name) {
         return;
     }
 
@@ -91,7 +104,7 @@ QSize Mode::size() const
 
 void Mode::setSize(const QSize &size)
 {
-    if (d->size == size) {
+    if (d.constData()->size == size) {
         return;
     }
 
@@ -107,7 +120,7 @@ float Mode::refreshRate() const
 
 void Mode::setRefreshRate(float refresh)
 {
-    if (qFuzzyCompare(d->rate, refresh)) {
+    if (qFuzzyCompare(d.constData()->rate, refresh)) {
         return;
     }
 
@@ -12,12 +12,41 @@
 #include "types.h"
 
 #include <QDebug>
+#include <QHashFunctions>
 #include <QMetaType>
 #include <QObject>
+#include <QSharedDataPointer>
 #include <QSize>
 
 namespace KScreen
 {
+/**
+ * A mode as a plain value.
+ *
+ * Outputs keep their modes in this form and only create Mode objects when
+ * asked for them, see Output::modeInfos().
+ *
+ * @since 6.0
+ */
+struct KSCREEN_EXPORT ModeInfo {
+    QString id;
+    QString name;
+    QSize size;
+    float refreshRate = 0;
+
+    bool isValid() const
+    {
+        return !id.isEmpty();
+    }
+
+    bool operator==(const ModeInfo &other) const = default;
+};
+
+inline size_t qHash(const ModeInfo &mode, size_t seed = 0)
+{
+    return qHashMulti(seed, mode.id, mode.name, mode.size.width(), mode.size.height(), mode.refreshRate);
+}
+
 class KSCREEN_EXPORT Mode : public QObject
 {
     Q_OBJECT
@@ -28,10 +57,21 @@ class KSCREEN_EXPORT Mode : public QObject
 
 public:
     explicit Mode();
+    /**
+     * Creates a mode with the values of @p info
+     * @since 6.0
+     */
+    explicit Mode(const ModeInfo &info);
     ~Mode() override;
 
     ModePtr clone() const;
 
+    /**
+     * @return the values of this mode
+     * @since 6.0
+     */
+    ModeInfo info() const;
+
     const QString id() const;
     void setId(const QString &id);
 
@@ -51,9 +91,9 @@ private:
     Q_DISABLE_COPY(Mode)
 
     class Private;
-    Private *const d;
+    QSharedDataPointer<Private> d;
 
-    Mode(Private *dd);
+    explicit Mode(const QSharedDataPointer<Private> &dd);
 };
 
 } // KSCreen namespace
@@ -6,166 +6,257 @@
  */
 
 #include "output.h"
+#include "configsnapshot.h"
 #include "edid.h"
+#include "fingerprint_p.h"
 #include "mode.h"
 
 #include <QCryptographicHash>
 #include <QGuiApplication>
 #include <QRect>
 #include <QScopedPointer>
+#include <QSharedData>
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <qobjectdefs.h>
 #include <utility>
 
 using namespace KScreen;
 
+namespace
+{
+bool modeIdLessThan(const ModeInfo &a, const ModeInfo &b)
+{
+    return a.id < b.id;
+}
+
+bool sameMode(const ModeInfo &a, const ModeInfo &b)
+{
+    return a.id == b.id && a.size == b.size && qFuzzyCompare(a.refreshRate, b.refreshRate) && a.name == b.name;
+}
+
+bool sameMode(const Mode &a, const ModeInfo &b)
+{
+    return a.id() == b.id && a.size() == b.size && qFuzzyCompare(a.refreshRate(), b.refreshRate) && a.name() == b.name;
+}
+
+// @p modes is sorted by id
+ModeInfo findMode(const QList<ModeInfo> &modes, const QString &id)
+{
+    const auto it = std::lower_bound(modes.cbegin(), modes.cend(), id, [](const ModeInfo &mode, const QString &id) {
+        return mode.id < id;
+    });
+    return it != modes.cend() && it->id == id ? *it : ModeInfo();
+}
+}
+
 class Q_DECL_HIDDEN Output::Private
 {
 public:
+    // The property values of an output, shared between an output and its clones
+    // until one of them changes
+    class Values : public QSharedData
+    {
+    public:
+        // please keep them consistent with order of Q_PROPERTY declarations
+        int id = 0;
+        QString name;
+        Output::Type type = Output::Unknown;
+        QString icon;
+        QPoint pos;
+        QSize size;
+        Output::Rotation rotation = Output::None;
+        // Sorted by id
+        QList<ModeInfo> modes;
+        QString currentMode;
+        QStringList preferredModes;
+        bool connected = false;
+        bool enabled = false;
+        uint32_t priority = 0;
+        QList<int> clones;
+        int replicationSource = 0;
+        QSize sizeMm;
+        qreal scale = 1.0;
+        bool followPreferredMode = false;
+        QSizeF explicitLogicalSize;
+        Output::Capabilities capabilities;
+        uint32_t overscan = 0;
+        Output::VrrPolicy vrrPolicy = Output::VrrPolicy::Automatic;
+        Output::RgbRange rgbRange = Output::RgbRange::Automatic;
+        bool highDynamicRange = false;
+        uint32_t sdrBrightness = 200;
+        bool wideColorGamut = false;
+    };
+
     Private()
-        : id(0)
-        , type(Unknown)
-        , replicationSource(0)
-        , rotation(None)
-        , scale(1.0)
-        , explicitLogicalSize(QSizeF())
-        , connected(false)
-        , enabled(false)
-        , priority(0)
-        , edid(nullptr)
+        : shared(new Values)
     {
     }
 
     Private(const Private &other)
-        : id(other.id)
-        , name(other.name)
-        , type(other.type)
-        , icon(other.icon)
-        , pos(other.pos)
-        , size(other.size)
-        , rotation(other.rotation)
-        , currentMode(other.currentMode)
+        : shared(other.shared)
         , preferredMode(other.preferredMode)
-        , preferredModes(other.preferredModes)
-        , connected(other.connected)
-        , enabled(other.enabled)
-        , priority(other.priority)
-        , clones(other.clones)
-        , replicationSource(other.replicationSource)
-        , sizeMm(other.sizeMm)
-        , scale(other.scale)
-        , followPreferredMode(other.followPreferredMode)
-        , explicitLogicalSize(other.explicitLogicalSize)
-        , capabilities(other.capabilities)
-        , overscan(other.overscan)
-        , vrrPolicy(other.vrrPolicy)
-        , rgbRange(other.rgbRange)
-        , highDynamicRange(other.highDynamicRange)
-        , sdrBrightness(other.sdrBrightness)
-        , wideColorGamut(other.wideColorGamut)
+        , identityFingerprint(other.identityFingerprint)
+        , stateFingerprint(other.stateFingerprint)
     {
-        const auto otherModeList = other.modeList;
-        for (const ModePtr &otherMode : otherModeList) {
-            modeList.insert(otherMode->id(), otherMode->clone());
+        // The Mode objects handed out by the original may have been changed since,
+        // the clone creates its own from their current values when asked for them
+        if (other.modeObjects) {
+            const QList<ModeInfo> modes = other.modeInfos();
+            if (modes != values().modes) {
+                mutableValues().modes = modes;
+            }
         }
+        // EDIDs share their data too, their clones are cheap
         if (other.edid) {
             edid.reset(other.edid->clone());
         }
     }
 
-    QString biggestMode(const ModeList &modes) const;
-    bool compareModeList(const ModeList &before, const ModeList &after);
-
-    // please keep them consistent with order of Q_PROPERTY declarations
-    int id;
-    QString name;
-    Type type;
-    QString icon;
-    ModeList modeList;
-    QPoint pos;
-    QSize size;
-    Rotation rotation;
-    // next three don't exactly match properties by name, but keep them close to each other anyway
-    QString currentMode;
-    QString preferredMode;
-    QStringList preferredModes;
-    //
-    bool connected;
-    bool enabled;
-    uint32_t priority;
-    QList<int> clones;
-    int replicationSource;
+    // Read access, never detaches
+    const Values &values() const
+    {
+        return *shared;
+    }
+
+    // Write access, detaches the values from other outputs sharing them
+    Values &mutableValues()
+    {
+        stateFingerprint.reset();
+        identityFingerprint.reset();
+        return *shared;
+    }
+
+    quint64 computeIdentityFingerprint(const Edid *edid) const;
+    quint64 computeStateFingerprint(quint64 identity) const;
+
+    QList<ModeInfo> modeInfos() const;
+    ModeInfo modeInfo(const QString &id) const;
+    const ModeList &modeList();
+
+    // Makes the modes equal to the sorted @p modes. Mode objects whose values are
+    // unchanged are kept. Returns whether anything changed.
+    bool updateModes(const QList<ModeInfo> &modes);
+
+    QString biggestMode(const QList<ModeInfo> &modes) const;
+    bool compareModeList(const QList<ModeInfo> &before, const QList<ModeInfo> &after) const;
+
+    QSharedDataPointer<Values> shared;
+    // The Mode and Edid objects are handed out to the user, so every output has its
+    // own. Once the Mode objects exist they are authoritative, as they may be changed.
+    std::optional<ModeList> modeObjects;
     QScopedPointer<Edid> edid;
-    QSize sizeMm;
-    qreal scale;
-    bool followPreferredMode = false;
-    QSizeF explicitLogicalSize;
-    Capabilities capabilities;
-    uint32_t overscan = 0;
-    VrrPolicy vrrPolicy = VrrPolicy::Automatic;
-    RgbRange rgbRange = RgbRange::Automatic;
-    bool highDynamicRange = false;
-    uint32_t sdrBrightness = 200;
-    bool wideColorGamut = false;
+    // Cache of preferredModeId()
+    QString preferredMode;
+    // Caches of fingerprint(), reset on every change
+    std::optional<quint64> identityFingerprint;
+    std::optional<quint64> stateFingerprint;
+    // The values at the outermost beginUpdate(), shared until the first change
+    QSharedDataPointer<Values> updateStart;
+    int updateDepth = 0;
+    bool signalsBlockedBeforeUpdate = false;
 };
 
-bool Output::Private::compareModeList(const ModeList &before, const ModeList &after)
+QList<ModeInfo> Output::Private::modeInfos() const
 {
-    if (before.count() != after.count()) {
-        return false;
+    if (!modeObjects) {
+        return values().modes;
     }
 
-    for (auto itb = before.constBegin(); itb != before.constEnd(); ++itb) {
-        auto ita = after.constFind(itb.key());
-        if (ita == after.constEnd()) {
-            return false;
-        }
-        const auto &mb = itb.value();
-        const auto &ma = ita.value();
-        if (mb->id() != ma->id()) {
-            return false;
-        }
-        if (mb->size() != ma->size()) {
-            return false;
-        }
-        if (!qFuzzyCompare(mb->refreshRate(), ma->refreshRate())) {
-            return false;
+    QList<ModeInfo> modes;
+    modes.reserve(modeObjects->count());
+    for (const ModePtr &mode : std::as_const(*modeObjects)) {
+        modes << mode->info();
+    }
+    return modes;
+}
+
+ModeInfo Output::Private::modeInfo(const QString &id) const
+{
+    if (modeObjects) {
+        const ModePtr mode = modeObjects->value(id);
+        return mode ? mode->info() : ModeInfo();
+    }
+
+    return findMode(values().modes, id);
+}
+
+const ModeList &Output::Private::modeList()
+{
+    if (!modeObjects) {
+        ModeList modes;
+        for (const ModeInfo &info : values().modes) {
+            modes.insert(info.id, ModePtr(new Mode(info)));
         }
-        if (mb->name() != ma->name()) {
+        modeObjects = modes;
+    }
+    return *modeObjects;
+}
+
+bool Output::Private::updateModes(const QList<ModeInfo> &modes)
+{
+    if (!modeObjects) {
+        if (compareModeList(values().modes, modes)) {
             return false;
         }
+        mutableValues().modes = modes;
+        return true;
+    }
+
+    // Both are sorted by id, compare them side by side without copying anything
+    if (modeObjects->count() == modes.count()
+        && std::equal(modeObjects->cbegin(), modeObjects->cend(), modes.cbegin(), [](const ModePtr &a, const ModeInfo &b) {
+               return sameMode(*a, b);
+           })) {
+        return false;
+    }
+
+    ModeList updated;
+    for (const ModeInfo &mode : modes) {
+        const ModePtr existing = modeObjects->value(mode.id);
+        updated.insert(mode.id, existing && sameMode(*existing, mode) ? existing : ModePtr(new Mode(mode)));
     }
-    // They're the same
+    modeObjects = updated;
+    mutableValues().modes = modes;
     return true;
 }
 
-QString Output::Private::biggestMode(const ModeList &modes) const
+bool Output::Private::compareModeList(const QList<ModeInfo> &before, const QList<ModeInfo> &after) const
+{
+    return std::equal(before.cbegin(), before.cend(), after.cbegin(), after.cend(), [](const ModeInfo &a, const ModeInfo &b) {
+        return sameMode(a, b);
+    });
+}
+
+QString Output::Private::biggestMode(const QList<ModeInfo> &modes) const
 {
     int area, total = 0;
-    KScreen::ModePtr biggest;
-    for (const KScreen::ModePtr &mode : modes) {
-        area = mode->size().width() * mode->size().height();
+    const ModeInfo *biggest = nullptr;
+    for (const ModeInfo &mode : modes) {
+        area = mode.size.width() * mode.size.height();
         if (area < total) {
             continue;
         }
-        if (area == total && mode->refreshRate() < biggest->refreshRate()) {
+        if (area == total && mode.refreshRate < biggest->refreshRate) {
             continue;
         }
-        if (area == total && mode->refreshRate() > biggest->refreshRate()) {
-            biggest = mode;
+        if (area == total && mode.refreshRate > biggest->refreshRate) {
+            biggest = &mode;
             continue;
         }
 
         total = area;
-        biggest = mode;
+        biggest = &mode;
     }
 
     if (!biggest) {
         return QString();
     }
 
-    return biggest->id();
+    return biggest->id;
 }
 
 Output::Output()
@@ -192,29 +283,29 @@ OutputPtr Output::clone() const
 
 int Output::id() const
 {
-    return d->id;
+    return d->values().id;
 }
 
 void Output::setId(int id)
 {
-    if (d->id == id) {
+    if (d->values().id == id) {
         return;
     }
-    d->id = id;
+    d->mutableValues().id = id;
     Q_EMIT outputChanged();
 }
 
 QString Output::name() const
 {
-    return d->name;
+    return d->values().name;
 }
 
 void Output::setName(const QString &name)
 {
-    if (d->name == name) {
+    if (d->values().name == name) {
         return;
     }
-    d->name = name;
+    d->mutableValues().name = name;
     Q_EMIT outputChanged();
 }
 
@@ -236,23 +327,75 @@ QString Output::hashMd5() const
     return QString::fromLatin1(hash.toHex());
 }
 
+quint64 Output::Private::computeIdentityFingerprint(const Edid *edid) const
+{
+    Fingerprint fingerprint;
+    // Same sources as hashMd5(), tagged so a name can't collide with an EDID hash
+    if (edid && edid->isValid()) {
+        fingerprint.add('E').add(edid->hash());
+    } else {
+        fingerprint.add('N').add(values().name);
+    }
+    return fingerprint.result();
+}
+
+quint64 Output::Private::computeStateFingerprint(quint64 identity) const
+{
+    const Values &v = values();
+    Fingerprint fingerprint;
+    fingerprint.add(identity)
+        .add(v.connected)
+        .add(v.enabled)
+        .add(v.priority)
+        .add(v.pos.x())
+        .add(v.pos.y())
+        .add(v.currentMode)
+        .add(v.rotation)
+        .add(v.scale)
+        .add(v.followPreferredMode)
+        .add(v.replicationSource)
+        .add(qint64(v.clones.size()))
+        .add(v.clones.constData(), v.clones.size() * sizeof(int))
+        .add(v.overscan)
+        .add(v.vrrPolicy)
+        .add(v.rgbRange)
+        .add(v.highDynamicRange)
+        .add(v.sdrBrightness)
+        .add(v.wideColorGamut);
+    return fingerprint.result();
+}
+
+quint64 Output::fingerprint(FingerprintScope scope) const
+{
+    if (!d->identityFingerprint) {
+        d->identityFingerprint = d->computeIdentityFingerprint(d->edid.data());
+    }
+    if (scope == FingerprintScope::Identity) {
+        return *d->identityFingerprint;
+    }
+    if (!d->stateFingerprint) {
+        d->stateFingerprint = d->computeStateFingerprint(*d->identityFingerprint);
+    }
+    return *d->stateFingerprint;
+}
+
 Output::Type Output::type() const
 {
-    return d->type;
+    return d->values().type;
 }
 
 void Output::setType(Type type)
 {
-    if (d->type == type) {
+    if (d->values().type == type) {
         return;
     }
-    d->type = type;
+    d->mutableValues().type = type;
     Q_EMIT outputChanged();
 }
 
 QString Output::typeName() const
 {
-    switch (d->type) {
+    switch (d->values().type) {
     case Output::Unknown:
         return QStringLiteral("Unknown");
     case Output::Panel:
@@ -284,75 +427,114 @@ QString Output::typeName() const
     case Output::DisplayPort:
         return QStringLiteral("DisplayPort");
     };
-    return QStringLiteral("Invalid Type") + QString::number(d->type);
+    return QStringLiteral("Invalid Type") + QString::number(d->values().type);
 }
 
 QString Output::icon() const
 {
-    return d->icon;
+    return d->values().icon;
 }
 
 void Output::setIcon(const QString &icon)
 {
-    if (d->icon == icon) {
+    if (d->values().icon == icon) {
         return;
     }
-    d->icon = icon;
+    d->mutableValues().icon = icon;
     Q_EMIT outputChanged();
 }
 
 ModePtr Output::mode(const QString &id) const
 {
-    if (!d->modeList.contains(id)) {
-        return ModePtr();
-    }
-
-    return d->modeList[id];
+    return d->modeList().value(id);
 }
 
 ModeList Output::modes() const
 {
-    return d->modeList;
+    return d->modeList();
 }
 
 void Output::setModes(const ModeList &modes)
 {
-    bool changed = !d->compareModeList(d->modeList, modes);
-    d->modeList = modes;
+    QList<ModeInfo> infos;
+    infos.reserve(modes.count());
+    for (const ModePtr &mode : modes) {
+        infos << mode->info();
+    }
+
+    bool changed = !d->compareModeList(d->modeInfos(), infos);
+    d->modeObjects = modes;
+    // Keeps clones from having to collect the values from the Mode objects
+    if (infos != d->values().modes) {
+        d->mutableValues().modes = infos;
+    }
     if (changed) {
         Q_EMIT modesChanged();
         Q_EMIT outputChanged();
     }
 }
 
+QList<ModeInfo> Output::modeInfos() const
+{
+    return d->modeInfos();
+}
+
+ModeInfo Output::modeInfo(const QString &id) const
+{
+    return d->modeInfo(id);
+}
+
+void Output::setModeInfos(const QList<ModeInfo> &modes)
+{
+    QList<ModeInfo> sorted = modes;
+    if (!std::is_sorted(sorted.cbegin(), sorted.cend(), modeIdLessThan)) {
+        std::stable_sort(sorted.begin(), sorted.end(), modeIdLessThan);
+    }
+    // Like ModeList, the last mode with a given id wins
+    const auto sameId = [](const ModeInfo &a, const ModeInfo &b) {
+        return a.id == b.id;
+    };
+    if (std::adjacent_find(sorted.cbegin(), sorted.cend(), sameId) != sorted.cend()) {
+        const auto first = std::unique(sorted.rbegin(), sorted.rend(), sameId);
+        sorted.erase(sorted.begin(), first.base());
+    }
+
+    if (d->updateModes(sorted)) {
+        Q_EMIT modesChanged();
+        Q_EMIT outputChanged();
+    }
+}
+
 QString Output::currentModeId() const
 {
-    return d->currentMode;
+    return d->values().currentMode;
 }
 
 void Output::setCurrentModeId(const QString &mode)
 {
-    if (d->currentMode == mode) {
+    if (d->values().currentMode == mode) {
         return;
     }
-    d->currentMode = mode;
+    d->mutableValues().currentMode = mode;
     Q_EMIT currentModeIdChanged();
 }
 
 ModePtr Output::currentMode() const
 {
-    return d->modeList.value(d->currentMode);
+    return d->modeList().value(d->values().currentMode);
 }
 
 void Output::setPreferredModes(const QStringList &modes)
 {
     d->preferredMode = QString();
-    d->preferredModes = modes;
+    if (d->values().preferredModes != modes) {
+        d->mutableValues().preferredModes = modes;
+    }
 }
 
 QStringList Output::preferredModes() const
 {
-    return d->preferredModes;
+    return d->values().preferredModes;
 }
 
 QString Output::preferredModeId() const
@@ -360,23 +542,22 @@ QString Output::preferredModeId() const
     if (!d->preferredMode.isEmpty()) {
         return d->preferredMode;
     }
-    if (d->preferredModes.isEmpty()) {
-        return d->biggestMode(modes());
+    if (d->values().preferredModes.isEmpty()) {
+        return d->biggestMode(d->modeInfos());
     }
 
     int total = 0;
-    KScreen::ModePtr biggest;
-    KScreen::ModePtr candidateMode;
-    for (const QString &modeId : std::as_const(d->preferredModes)) {
-        candidateMode = mode(modeId);
-        const int area = candidateMode->size().width() * candidateMode->size().height();
+    ModeInfo biggest;
+    for (const QString &modeId : std::as_const(d->values().preferredModes)) {
+        const ModeInfo candidateMode = d->modeInfo(modeId);
+        const int area = candidateMode.size.width() * candidateMode.size.height();
         if (area < total) {
             continue;
         }
-        if (area == total && biggest && candidateMode->refreshRate() < biggest->refreshRate()) {
+        if (area == total && biggest.isValid() && candidateMode.refreshRate < biggest.refreshRate) {
             continue;
         }
-        if (area == total && biggest && candidateMode->refreshRate() > biggest->refreshRate()) {
+        if (area == total && biggest.isValid() && candidateMode.refreshRate > biggest.refreshRate) {
             biggest = candidateMode;
             continue;
         }
@@ -385,119 +566,119 @@ QString Output::preferredModeId() const
         biggest = candidateMode;
     }
 
-    Q_ASSERT_X(biggest, "preferredModeId", "biggest mode must exist");
+    Q_ASSERT_X(biggest.isValid(), "preferredModeId", "biggest mode must exist");
 
-    d->preferredMode = biggest->id();
+    d->preferredMode = biggest.id;
     return d->preferredMode;
 }
 
 ModePtr Output::preferredMode() const
 {
-    return d->modeList.value(preferredModeId());
+    return d->modeList().value(preferredModeId());
 }
 
 QPoint Output::pos() const
 {
-    return d->pos;
+    return d->values().pos;
 }
 
 void Output::setPos(const QPoint &pos)
 {
-    if (d->pos == pos) {
+    if (d->values().pos == pos) {
         return;
     }
-    d->pos = pos;
+    d->mutableValues().pos = pos;
     Q_EMIT posChanged();
 }
 
 QSize Output::size() const
 {
-    return d->size;
+    return d->values().size;
 }
 
 void Output::setSize(const QSize &size)
 {
-    if (d->size == size) {
+    if (d->values().size == size) {
         return;
     }
-    d->size = size;
+    d->mutableValues().size = size;
     Q_EMIT sizeChanged();
 }
 
 // TODO KF6: make the Rotation enum an enum class and align values with Wayland transformation property
 Output::Rotation Output::rotation() const
 {
-    return d->rotation;
+    return d->values().rotation;
 }
 
 void Output::setRotation(Output::Rotation rotation)
 {
-    if (d->rotation == rotation) {
+    if (d->values().rotation == rotation) {
         return;
     }
-    d->rotation = rotation;
+    d->mutableValues().rotation = rotation;
     Q_EMIT rotationChanged();
 }
 
 qreal Output::scale() const
 {
-    return d->scale;
+    return d->values().scale;
 }
 
 void Output::setScale(qreal factor)
 {
-    if (qFuzzyCompare(d->scale, factor)) {
+    if (qFuzzyCompare(d->values().scale, factor)) {
         return;
     }
-    d->scale = factor;
+    d->mutableValues().scale = factor;
     Q_EMIT scaleChanged();
 }
 
 QSizeF Output::explicitLogicalSize() const
 {
-    return d->explicitLogicalSize;
+    return d->values().explicitLogicalSize;
 }
 
 void Output::setExplicitLogicalSize(const QSizeF &size)
 {
-    if (qFuzzyCompare(d->explicitLogicalSize.width(), size.width()) && qFuzzyCompare(d->explicitLogicalSize.height(), size.height())) {
+    if (qFuzzyCompare(d->values().explicitLogicalSize.width(), size.width()) && qFuzzyCompare(d->values().explicitLogicalSize.height(), size.height())) {
         return;
     }
-    d->explicitLogicalSize = size;
+    d->mutableValues().explicitLogicalSize = size;
     Q_EMIT explicitLogicalSizeChanged();
 }
 
 bool Output::isConnected() const
 {
-    return d->connected;
+    return d->values().connected;
 }
 
 void Output::setConnected(bool connected)
 {
-    if (d->connected == connected) {
+    if (d->values().connected == connected) {
         return;
     }
-    d->connected = connected;
+    d->mutableValues().connected = connected;
     Q_EMIT isConnectedChanged();
 }
 
 bool Output::isEnabled() const
 {
-    return d->enabled;
+    return d->values().enabled;
 }
 
 void Output::setEnabled(bool enabled)
 {
-    if (d->enabled == enabled) {
+    if (d->values().enabled == enabled) {
         return;
     }
-    d->enabled = enabled;
+    d->mutableValues().enabled = enabled;
     Q_EMIT isEnabledChanged();
 }
 
 bool Output::isPrimary() const
 {
-    return d->enabled && (d->priority == 1);
+    return d->values().enabled && (d->values().priority == 1);
 }
 
 void Output::setPrimary(bool primary)
@@ -507,43 +688,43 @@ void Output::setPrimary(bool primary)
 
 uint32_t Output::priority() const
 {
-    return d->priority;
+    return d->values().priority;
 }
 
 void Output::setPriority(uint32_t priority)
 {
-    if (d->priority == priority) {
+    if (d->values().priority == priority) {
         return;
     }
-    d->priority = priority;
+    d->mutableValues().priority = priority;
     Q_EMIT priorityChanged();
 }
 
 QList<int> Output::clones() const
 {
-    return d->clones;
+    return d->values().clones;
 }
 
 void Output::setClones(const QList<int> &outputlist)
 {
-    if (d->clones == outputlist) {
+    if (d->values().clones == outputlist) {
         return;
     }
-    d->clones = outputlist;
+    d->mutableValues().clones = outputlist;
     Q_EMIT clonesChanged();
 }
 
 int Output::replicationSource() const
 {
-    return d->replicationSource;
+    return d->values().replicationSource;
 }
 
 void Output::setReplicationSource(int source)
 {
-    if (d->replicationSource == source) {
+    if (d->values().replicationSource == source) {
         return;
     }
-    d->replicationSource = source;
+    d->mutableValues().replicationSource = source;
     Q_EMIT replicationSourceChanged();
 }
 
@@ -551,6 +732,16 @@ void Output::setEdid(const QByteArray &rawData)
 {
     Q_ASSERT(d->edid.isNull());
     d->edid.reset(new Edid(rawData));
+    d->identityFingerprint.reset();
+    d->stateFingerprint.reset();
+}
+
+void Output::adoptEdid(Edid *edid)
+{
+    Q_ASSERT(d->edid.isNull());
+    d->edid.reset(edid);
+    d->identityFingerprint.reset();
+    d->stateFingerprint.reset();
 }
 
 Edid *Output::edid() const
@@ -560,25 +751,25 @@ Edid *Output::edid() const
 
 QSize Output::sizeMm() const
 {
-    return d->sizeMm;
+    return d->values().sizeMm;
 }
 
 void Output::setSizeMm(const QSize &size)
 {
-    d->sizeMm = size;
+    d->mutableValues().sizeMm = size;
 }
 
 bool KScreen::Output::followPreferredMode() const
 {
-    return d->followPreferredMode;
+    return d->values().followPreferredMode;
 }
 
 void KScreen::Output::setFollowPreferredMode(bool follow)
 {
-    if (follow == d->followPreferredMode) {
+    if (follow == d->values().followPreferredMode) {
         return;
     }
-    d->followPreferredMode = follow;
+    d->mutableValues().followPreferredMode = follow;
     Q_EMIT followPreferredModeChanged(follow);
 }
 
@@ -589,12 +780,12 @@ bool Output::isPositionable() const
 
 QSize Output::enforcedModeSize() const
 {
-    if (const auto mode = currentMode()) {
-        return mode->size();
-    } else if (const auto mode = preferredMode()) {
-        return mode->size();
-    } else if (d->modeList.count() > 0) {
-        return d->modeList.first()->size();
+    if (const ModeInfo mode = d->modeInfo(d->values().currentMode); mode.isValid()) {
+        return mode.size;
+    } else if (const ModeInfo mode = d->modeInfo(preferredModeId()); mode.isValid()) {
+        return mode.size;
+    } else if (const QList<ModeInfo> modes = d->modeInfos(); !modes.isEmpty()) {
+        return modes.first().size;
     }
     return QSize();
 }
@@ -606,205 +797,224 @@ QRect Output::geometry() const
         return QRect();
     }
 
-    return QRect(d->pos, size);
+    return QRect(d->values().pos, size);
 }
 
 Output::Capabilities Output::capabilities() const
 {
-    return d->capabilities;
+    return d->values().capabilities;
 }
 
 void Output::setCapabilities(Capabilities capabilities)
 {
-    if (d->capabilities == capabilities) {
+    if (d->values().capabilities == capabilities) {
         return;
     }
-    d->capabilities = capabilities;
+    d->mutableValues().capabilities = capabilities;
     Q_EMIT capabilitiesChanged();
 }
 
 uint32_t Output::overscan() const
 {
-    return d->overscan;
+    return d->values().overscan;
 }
 
 void Output::setOverscan(uint32_t overscan)
 {
-    if (d->overscan == overscan) {
+    if (d->values().overscan == overscan) {
         return;
     }
-    d->overscan = overscan;
+    d->mutableValues().overscan = overscan;
     Q_EMIT overscanChanged();
 }
 
 Output::VrrPolicy Output::vrrPolicy() const
 {
-    return d->vrrPolicy;
+    return d->values().vrrPolicy;
 }
 
 void Output::setVrrPolicy(VrrPolicy policy)
 {
-    if (d->vrrPolicy == policy) {
+    if (d->values().vrrPolicy == policy) {
         return;
     }
-    d->vrrPolicy = policy;
+    d->mutableValues().vrrPolicy = policy;
     Q_EMIT vrrPolicyChanged();
 }
 
 Output::RgbRange Output::rgbRange() const
 {
-    return d->rgbRange;
+    return d->values().rgbRange;
 }
 
 void Output::setRgbRange(Output::RgbRange rgbRange)
 {
-    if (d->rgbRange == rgbRange) {
+    if (d->values().rgbRange == rgbRange) {
         return;
     }
-    d->rgbRange = rgbRange;
+    d->mutableValues().rgbRange = rgbRange;
     Q_EMIT rgbRangeChanged();
 }
 
 bool Output::isHdrEnabled() const
 {
-    return d->highDynamicRange;
+    return d->values().highDynamicRange;
 }
 
 void Output::setHdrEnabled(bool enable)
 {
-    if (d->highDynamicRange != enable) {
-        d->highDynamicRange = enable;
+    if (d->values().highDynamicRange != enable) {
+        d->mutableValues().highDynamicRange = enable;
         Q_EMIT hdrEnabledChanged();
     }
 }
 
 uint32_t Output::sdrBrightness() const
 {
-    return d->sdrBrightness;
+    return d->values().sdrBrightness;
 }
 
 void Output::setSdrBrightness(uint32_t brightness)
 {
-    if (d->sdrBrightness != brightness) {
-        d->sdrBrightness = brightness;
+    if (d->values().sdrBrightness != brightness) {
+        d->mutableValues().sdrBrightness = brightness;
         Q_EMIT sdrBrightnessChanged();
     }
 }
 
 bool Output::isWcgEnabled() const
 {
-    return d->wideColorGamut;
+    return d->values().wideColorGamut;
 }
 
 void Output::setWcgEnabled(bool enable)
 {
-    if (d->wideColorGamut != enable) {
-        d->wideColorGamut = enable;
+    if (d->values().wideColorGamut != enable) {
+        d->mutableValues().wideColorGamut = enable;
         Q_EMIT wcgEnabledChanged();
     }
 }
 
-void Output::apply(const OutputPtr &other)
+Output::Changes Output::apply(const OutputPtr &other)
 {
     typedef void (KScreen::Output::*ChangeSignal)();
     QList<ChangeSignal> changes;
+    Changes changed;
 
     // We block all signals, and emit them only after we have set up everything
     // This is necessary in order to prevent clients from accessing inconsistent
     // outputs from intermediate change signals
     const bool keepBlocked = blockSignals(true);
-    if (d->name != other->d->name) {
+    if (d->values().name != other->d->values().name) {
         changes << &Output::outputChanged;
-        setName(other->d->name);
+        changed |= Change::Name;
+        setName(other->d->values().name);
     }
-    if (d->type != other->d->type) {
+    if (d->values().type != other->d->values().type) {
         changes << &Output::outputChanged;
-        setType(other->d->type);
+        changed |= Change::Name;
+        setType(other->d->values().type);
     }
-    if (d->icon != other->d->icon) {
+    if (d->values().icon != other->d->values().icon) {
         changes << &Output::outputChanged;
-        setIcon(other->d->icon);
+        changed |= Change::Name;
+        setIcon(other->d->values().icon);
     }
-    if (d->pos != other->d->pos) {
+    if (d->values().pos != other->d->values().pos) {
         changes << &Output::posChanged;
+        changed |= Change::Position;
         setPos(other->pos());
     }
-    if (d->rotation != other->d->rotation) {
+    if (d->values().rotation != other->d->values().rotation) {
         changes << &Output::rotationChanged;
-        setRotation(other->d->rotation);
+        changed |= Change::Rotation;
+        setRotation(other->d->values().rotation);
     }
-    if (!qFuzzyCompare(d->scale, other->d->scale)) {
+    if (!qFuzzyCompare(d->values().scale, other->d->values().scale)) {
         changes << &Output::scaleChanged;
-        setScale(other->d->scale);
+        changed |= Change::Scale;
+        setScale(other->d->values().scale);
     }
-    if (d->currentMode != other->d->currentMode) {
+    if (d->values().currentMode != other->d->values().currentMode) {
         changes << &Output::currentModeIdChanged;
-        setCurrentModeId(other->d->currentMode);
+        changed |= Change::CurrentMode;
+        setCurrentModeId(other->d->values().currentMode);
     }
-    if (d->connected != other->d->connected) {
+    if (d->values().connected != other->d->values().connected) {
         changes << &Output::isConnectedChanged;
-        setConnected(other->d->connected);
+        changed |= Change::Connected;
+        setConnected(other->d->values().connected);
     }
-    if (d->enabled != other->d->enabled) {
+    if (d->values().enabled != other->d->values().enabled) {
         changes << &Output::isEnabledChanged;
-        setEnabled(other->d->enabled);
+        changed |= Change::Enabled;
+        setEnabled(other->d->values().enabled);
     }
-    if (d->priority != other->d->priority) {
+    if (d->values().priority != other->d->values().priority) {
         changes << &Output::priorityChanged;
-        setPriority(other->d->priority);
+        changed |= Change::Priority;
+        setPriority(other->d->values().priority);
     }
-    if (d->clones != other->d->clones) {
+    if (d->values().clones != other->d->values().clones) {
         changes << &Output::clonesChanged;
-        setClones(other->d->clones);
+        changed |= Change::Clones;
+        setClones(other->d->values().clones);
     }
-    if (d->replicationSource != other->d->replicationSource) {
+    if (d->values().replicationSource != other->d->values().replicationSource) {
         changes << &Output::replicationSourceChanged;
-        setReplicationSource(other->d->replicationSource);
+        changed |= Change::ReplicationSource;
+        setReplicationSource(other->d->values().replicationSource);
     }
-    if (!d->compareModeList(d->modeList, other->d->modeList)) {
+    // Only the modes that differ are replaced, Mode objects handed out before stay valid
+    if (d->updateModes(other->d->modeInfos())) {
         changes << &Output::outputChanged;
         changes << &Output::modesChanged;
+        changed |= Change::Modes;
     }
 
-    setPreferredModes(other->d->preferredModes);
-    ModeList modes;
-    for (const ModePtr &otherMode : other->modes()) {
-        modes.insert(otherMode->id(), otherMode->clone());
-    }
-    setModes(modes);
+    setPreferredModes(other->d->values().preferredModes);
 
-    if (d->capabilities != other->d->capabilities) {
+    if (d->values().capabilities != other->d->values().capabilities) {
         changes << &Output::capabilitiesChanged;
-        setCapabilities(other->d->capabilities);
+        changed |= Change::Capabilities;
+        setCapabilities(other->d->values().capabilities);
     }
-    if (d->vrrPolicy != other->d->vrrPolicy) {
+    if (d->values().vrrPolicy != other->d->values().vrrPolicy) {
         changes << &Output::vrrPolicyChanged;
-        setVrrPolicy(other->d->vrrPolicy);
+        changed |= Change::VrrPolicy;
+        setVrrPolicy(other->d->values().vrrPolicy);
     }
-    if (d->overscan != other->d->overscan) {
+    if (d->values().overscan != other->d->values().overscan) {
         changes << &Output::overscanChanged;
-        setOverscan(other->d->overscan);
+        changed |= Change::Overscan;
+        setOverscan(other->d->values().overscan);
     }
-    if (d->rgbRange != other->d->rgbRange) {
+    if (d->values().rgbRange != other->d->values().rgbRange) {
         changes << &Output::rgbRangeChanged;
-        setRgbRange(other->d->rgbRange);
+        changed |= Change::RgbRange;
+        setRgbRange(other->d->values().rgbRange);
     }
-    if (d->highDynamicRange != other->d->highDynamicRange) {
+    if (d->values().highDynamicRange != other->d->values().highDynamicRange) {
         changes << &Output::hdrEnabledChanged;
-        setHdrEnabled(other->d->highDynamicRange);
+        changed |= Change::Hdr;
+        setHdrEnabled(other->d->values().highDynamicRange);
     }
-    if (d->sdrBrightness != other->d->sdrBrightness) {
+    if (d->values().sdrBrightness != other->d->values().sdrBrightness) {
         changes << &Output::sdrBrightnessChanged;
-        setSdrBrightness(other->d->sdrBrightness);
+        changed |= Change::SdrBrightness;
+        setSdrBrightness(other->d->values().sdrBrightness);
     }
-    if (d->wideColorGamut != other->d->wideColorGamut) {
+    if (d->values().wideColorGamut != other->d->values().wideColorGamut) {
         changes << &Output::wcgEnabledChanged;
-        setWcgEnabled(other->d->wideColorGamut);
+        changed |= Change::Wcg;
+        setWcgEnabled(other->d->values().wideColorGamut);
     }
 
     // Non-notifyable changes
     if (other->d->edid) {
         d->edid.reset(other->d->edid->clone());
+        d->identityFingerprint.reset();
+        d->stateFingerprint.reset();
     }
 
     blockSignals(keepBlocked);
@@ -814,6 +1024,539 @@ void Output::apply(const OutputPtr &other)
         Q_EMIT(this->*sig)();
         changes.removeAll(sig);
     }
+    return changed;
+}
+
+bool Output::sharesState(const Output &other) const
+{
+    if (d->shared != other.d->shared) {
+        return false;
+    }
+    // Mode objects handed out may have been changed without touching the values
+    return (!d->modeObjects || d->modeInfos() == d->values().modes) && (!other.d->modeObjects || other.d->modeInfos() == other.d->values().modes);
+}
+
+const void *Output::stateData() const
+{
+    return d->shared.constData();
+}
+
+void Output::adoptState(const Output &leader, Changes changes)
+{
+    const QSizeF explicitLogicalSize = d->values().explicitLogicalSize;
+    d->shared = leader.d->shared;
+    d->preferredMode = leader.d->preferredMode;
+    d->identityFingerprint.reset();
+    d->stateFingerprint.reset();
+    if (d->modeObjects && changes.testFlag(Change::Modes)) {
+        ModeList updated;
+        for (const ModeInfo &mode : std::as_const(d->values().modes)) {
+            const ModePtr existing = d->modeObjects->value(mode.id);
+            updated.insert(mode.id, existing && sameMode(*existing, mode) ? existing : ModePtr(new Mode(mode)));
+        }
+        d->modeObjects = updated;
+    }
+    // Like apply(), which took the EDID of the new config if it had one
+    if (leader.d->edid && (!d->edid || d->edid->hash() != leader.d->edid->hash())) {
+        d->edid.reset(leader.d->edid->clone());
+    }
+
+    // In the order apply() emits them
+    if (changes.testAnyFlags(Change::Name | Change::Modes)) {
+        Q_EMIT outputChanged();
+    }
+    if (changes.testFlag(Change::Position)) {
+        Q_EMIT posChanged();
+    }
+    if (changes.testFlag(Change::Rotation)) {
+        Q_EMIT rotationChanged();
+    }
+    if (changes.testFlag(Change::Scale)) {
+        Q_EMIT scaleChanged();
+    }
+    if (changes.testFlag(Change::CurrentMode)) {
+        Q_EMIT currentModeIdChanged();
+    }
+    if (changes.testFlag(Change::Connected)) {
+        Q_EMIT isConnectedChanged();
+    }
+    if (changes.testFlag(Change::Enabled)) {
+        Q_EMIT isEnabledChanged();
+    }
+    if (changes.testFlag(Change::Priority)) {
+        Q_EMIT priorityChanged();
+    }
+    if (changes.testFlag(Change::Clones)) {
+        Q_EMIT clonesChanged();
+    }
+    if (changes.testFlag(Change::ReplicationSource)) {
+        Q_EMIT replicationSourceChanged();
+    }
+    if (changes.testFlag(Change::Modes)) {
+        Q_EMIT modesChanged();
+    }
+    if (changes.testFlag(Change::Capabilities)) {
+        Q_EMIT capabilitiesChanged();
+    }
+    if (changes.testFlag(Change::VrrPolicy)) {
+        Q_EMIT vrrPolicyChanged();
+    }
+    if (changes.testFlag(Change::Overscan)) {
+        Q_EMIT overscanChanged();
+    }
+    if (changes.testFlag(Change::RgbRange)) {
+        Q_EMIT rgbRangeChanged();
+    }
+    if (changes.testFlag(Change::Hdr)) {
+        Q_EMIT hdrEnabledChanged();
+    }
+    if (changes.testFlag(Change::SdrBrightness)) {
+        Q_EMIT sdrBrightnessChanged();
+    }
+    if (changes.testFlag(Change::Wcg)) {
+        Q_EMIT wcgEnabledChanged();
+    }
+    // Not part of the changes, apply() leaves it to the config, which set it on the leader
+    const QSizeF &adopted = d->values().explicitLogicalSize;
+    if (!qFuzzyCompare(explicitLogicalSize.width(), adopted.width()) || !qFuzzyCompare(explicitLogicalSize.height(), adopted.height())) {
+        Q_EMIT explicitLogicalSizeChanged();
+    }
+}
+
+Output::Changes Output::diff(const OutputPtr &base) const
+{
+    const Private::Values &a = base->d->values();
+    const Private::Values &b = d->values();
+    if (&a == &b && !d->modeObjects && !base->d->modeObjects) {
+        return Change::None;
+    }
+
+    Changes changes;
+    if (a.name != b.name || a.type != b.type || a.icon != b.icon) {
+        changes |= Change::Name;
+    }
+    if (a.pos != b.pos) {
+        changes |= Change::Position;
+    }
+    if (a.rotation != b.rotation) {
+        changes |= Change::Rotation;
+    }
+    if (!qFuzzyCompare(a.scale, b.scale)) {
+        changes |= Change::Scale;
+    }
+    if (a.currentMode != b.currentMode) {
+        changes |= Change::CurrentMode;
+    }
+    if (a.connected != b.connected) {
+        changes |= Change::Connected;
+    }
+    if (a.enabled != b.enabled) {
+        changes |= Change::Enabled;
+    }
+    if (a.priority != b.priority) {
+        changes |= Change::Priority;
+    }
+    if (a.clones != b.clones) {
+        changes |= Change::Clones;
+    }
+    if (a.replicationSource != b.replicationSource) {
+        changes |= Change::ReplicationSource;
+    }
+    if (!d->compareModeList(base->d->modeInfos(), d->modeInfos())) {
+        changes |= Change::Modes;
+    }
+    if (a.capabilities != b.capabilities) {
+        changes |= Change::Capabilities;
+    }
+    if (a.overscan != b.overscan) {
+        changes |= Change::Overscan;
+    }
+    if (a.vrrPolicy != b.vrrPolicy) {
+        changes |= Change::VrrPolicy;
+    }
+    if (a.rgbRange != b.rgbRange) {
+        changes |= Change::RgbRange;
+    }
+    if (a.highDynamicRange != b.highDynamicRange) {
+        changes |= Change::Hdr;
+    }
+    if (a.sdrBrightness != b.sdrBrightness) {
+        changes |= Change::SdrBrightness;
+    }
+    if (a.wideColorGamut != b.wideColorGamut) {
+        changes |= Change::Wcg;
+    }
+    return changes;
+}
+
+void Output::beginUpdate()
+{
+    if (d->updateDepth++ > 0) {
+        return;
+    }
+    d->updateStart = d->shared;
+    d->signalsBlockedBeforeUpdate = blockSignals(true);
+}
+
+void Output::endUpdate()
+{
+    Q_ASSERT(d->updateDepth > 0);
+    if (--d->updateDepth > 0) {
+        return;
+    }
+
+    blockSignals(d->signalsBlockedBeforeUpdate);
+    const QSharedDataPointer<Private::Values> before = std::exchange(d->updateStart, QSharedDataPointer<Private::Values>());
+    const Private::Values &after = d->values();
+    if (before.constData() == &after) {
+        return;
+    }
+
+    const bool modesDiffer = !d->compareModeList(before->modes, after.modes);
+    if (before->id != after.id || before->name != after.name || before->type != after.type || before->icon != after.icon || modesDiffer) {
+        Q_EMIT outputChanged();
+    }
+    if (modesDiffer) {
+        Q_EMIT modesChanged();
+    }
+    if (before->currentMode != after.currentMode) {
+        Q_EMIT currentModeIdChanged();
+    }
+    if (before->pos != after.pos) {
+        Q_EMIT posChanged();
+    }
+    if (before->size != after.size) {
+        Q_EMIT sizeChanged();
+    }
+    if (before->rotation != after.rotation) {
+        Q_EMIT rotationChanged();
+    }
+    if (!qFuzzyCompare(before->scale, after.scale)) {
+        Q_EMIT scaleChanged();
+    }
+    if (before->explicitLogicalSize != after.explicitLogicalSize) {
+        Q_EMIT explicitLogicalSizeChanged();
+    }
+    if (before->connected != after.connected) {
+        Q_EMIT isConnectedChanged();
+    }
+    if (before->enabled != after.enabled) {
+        Q_EMIT isEnabledChanged();
+    }
+    if (before->priority != after.priority) {
+        Q_EMIT priorityChanged();
+    }
+    if (before->clones != after.clones) {
+        Q_EMIT clonesChanged();
+    }
+    if (before->replicationSource != after.replicationSource) {
+        Q_EMIT replicationSourceChanged();
+    }
+    if (before->followPreferredMode != after.followPreferredMode) {
+        Q_EMIT followPreferredModeChanged(after.followPreferredMode);
+    }
+    if (before->capabilities != after.capabilities) {
+        Q_EMIT capabilitiesChanged();
+    }
+    if (before->overscan != after.overscan) {
+        Q_EMIT overscanChanged();
+    }
+    if (before->vrrPolicy != after.vrrPolicy) {
+        Q_EMIT vrrPolicyChanged();
+    }
+    if (before->rgbRange != after.rgbRange) {
+        Q_EMIT rgbRangeChanged();
+    }
+    if (before->highDynamicRange != after.highDynamicRange) {
+        Q_EMIT hdrEnabledChanged();
+    }
+    if (before->sdrBrightness != after.sdrBrightness) {
+        Q_EMIT sdrBrightnessChanged();
+    }
+    if (before->wideColorGamut != after.wideColorGamut) {
+        Q_EMIT wcgEnabledChanged();
+    }
+}
+
+namespace KScreen
+{
+class OutputSnapshotData : public QSharedData
+{
+public:
+    using Values = Output::Private::Values;
+
+    // Only ever read, the data is never detached
+    QSharedDataPointer<Values> shared;
+    // Not associated with any thread, so whichever thread drops the last
+    // snapshot can delete it
+    std::unique_ptr<Edid> edid;
+    QString preferredModeId;
+    quint64 identityFingerprint = 0;
+    quint64 stateFingerprint = 0;
+};
+}
+
+namespace
+{
+const OutputSnapshotData::Values &snapshotValues(const QExplicitlySharedDataPointer<OutputSnapshotData> &d)
+{
+    static const OutputSnapshotData::Values s_nullValues;
+    return d ? *d->shared.constData() : s_nullValues;
+}
+}
+
+OutputSnapshot Output::snapshot() const
+{
+    // Fill the fingerprint caches first, the copy takes them over
+    fingerprint(FingerprintScope::State);
+
+    // The copy folds changes made through the Mode objects into its values
+    Private copy(*d);
+    auto *data = new OutputSnapshotData;
+    data->shared = copy.shared;
+    if (copy.edid) {
+        copy.edid->moveToThread(nullptr);
+        data->edid.reset(copy.edid.take());
+    }
+    data->preferredModeId = preferredModeId();
+    if (!copy.stateFingerprint) {
+        copy.identityFingerprint = copy.computeIdentityFingerprint(data->edid.get());
+        copy.stateFingerprint = copy.computeStateFingerprint(*copy.identityFingerprint);
+    }
+    data->identityFingerprint = *copy.identityFingerprint;
+    data->stateFingerprint = *copy.stateFingerprint;
+    return OutputSnapshot(data);
+}
+
+OutputSnapshot::OutputSnapshot() = default;
+
+OutputSnapshot::OutputSnapshot(OutputSnapshotData *dd)
+    : d(dd)
+{
+}
+
+OutputSnapshot::OutputSnapshot(const OutputSnapshot &other) = default;
+
+OutputSnapshot &OutputSnapshot::operator=(const OutputSnapshot &other) = default;
+
+OutputSnapshot::~OutputSnapshot() = default;
+
+bool OutputSnapshot::isNull() const
+{
+    return !d;
+}
+
+int OutputSnapshot::id() const
+{
+    return snapshotValues(d).id;
+}
+
+QString OutputSnapshot::name() const
+{
+    return snapshotValues(d).name;
+}
+
+QString OutputSnapshot::hash() const
+{
+    if (edid() && edid()->isValid()) {
+        return edid()->hash();
+    }
+    return name();
+}
+
+Output::Type OutputSnapshot::type() const
+{
+    return snapshotValues(d).type;
+}
+
+QString OutputSnapshot::icon() const
+{
+    return snapshotValues(d).icon;
+}
+
+QList<ModeInfo> OutputSnapshot::modeInfos() const
+{
+    return snapshotValues(d).modes;
+}
+
+ModeInfo OutputSnapshot::modeInfo(const QString &modeId) const
+{
+    return findMode(snapshotValues(d).modes, modeId);
+}
+
+QString OutputSnapshot::currentModeId() const
+{
+    return snapshotValues(d).currentMode;
+}
+
+QStringList OutputSnapshot::preferredModes() const
+{
+    return snapshotValues(d).preferredModes;
+}
+
+QString OutputSnapshot::preferredModeId() const
+{
+    return d ? d->preferredModeId : QString();
+}
+
+QPoint OutputSnapshot::pos() const
+{
+    return snapshotValues(d).pos;
+}
+
+QSize OutputSnapshot::size() const
+{
+    return snapshotValues(d).size;
+}
+
+QSize OutputSnapshot::enforcedModeSize() const
+{
+    if (const ModeInfo mode = modeInfo(currentModeId()); mode.isValid()) {
+        return mode.size;
+    } else if (const ModeInfo mode = modeInfo(preferredModeId()); mode.isValid()) {
+        return mode.size;
+    } else if (const QList<ModeInfo> &modes = snapshotValues(d).modes; !modes.isEmpty()) {
+        return modes.first().size;
+    }
+    return QSize();
+}
+
+Output::Rotation OutputSnapshot::rotation() const
+{
+    return snapshotValues(d).rotation;
+}
+
+bool OutputSnapshot::isHorizontal() const
+{
+    return rotation() == Output::None || rotation() == Output::Inverted;
+}
+
+bool OutputSnapshot::isConnected() const
+{
+    return snapshotValues(d).connected;
+}
+
+bool OutputSnapshot::isEnabled() const
+{
+    return snapshotValues(d).enabled;
+}
+
+bool OutputSnapshot::isPrimary() const
+{
+    return isEnabled() && priority() == 1;
+}
+
+uint32_t OutputSnapshot::priority() const
+{
+    return snapshotValues(d).priority;
+}
+
+QList<int> OutputSnapshot::clones() const
+{
+    return snapshotValues(d).clones;
+}
+
+int OutputSnapshot::replicationSource() const
+{
+    return snapshotValues(d).replicationSource;
+}
+
+bool OutputSnapshot::isPositionable() const
+{
+    return isConnected() && isEnabled() && !replicationSource();
+}
+
+QSize OutputSnapshot::sizeMm() const
+{
+    return snapshotValues(d).sizeMm;
+}
+
+QRect OutputSnapshot::geometry() const
+{
+    const QSize size = explicitLogicalSize().toSize();
+    if (!size.isValid()) {
+        return QRect();
+    }
+    return QRect(pos(), size);
+}
+
+qreal OutputSnapshot::scale() const
+{
+    return snapshotValues(d).scale;
+}
+
+QSizeF OutputSnapshot::explicitLogicalSize() const
+{
+    return snapshotValues(d).explicitLogicalSize;
+}
+
+bool OutputSnapshot::followPreferredMode() const
+{
+    return snapshotValues(d).followPreferredMode;
+}
+
+Output::Capabilities OutputSnapshot::capabilities() const
+{
+    return snapshotValues(d).capabilities;
+}
+
+uint32_t OutputSnapshot::overscan() const
+{
+    return snapshotValues(d).overscan;
+}
+
+Output::VrrPolicy OutputSnapshot::vrrPolicy() const
+{
+    return snapshotValues(d).vrrPolicy;
+}
+
+Output::RgbRange OutputSnapshot::rgbRange() const
+{
+    return snapshotValues(d).rgbRange;
+}
+
+bool OutputSnapshot::isHdrEnabled() const
+{
+    return snapshotValues(d).highDynamicRange;
+}
+
+uint32_t OutputSnapshot::sdrBrightness() const
+{
+    return snapshotValues(d).sdrBrightness;
+}
+
+bool OutputSnapshot::isWcgEnabled() const
+{
+    return snapshotValues(d).wideColorGamut;
+}
+
+const Edid *OutputSnapshot::edid() const
+{
+    return d ? d->edid.get() : nullptr;
+}
+
+quint64 OutputSnapshot::fingerprint(Output::FingerprintScope scope) const
+{
+    if (!d) {
+        return 0;
+    }
+    return scope == Output::FingerprintScope::Identity ? d->identityFingerprint : d->stateFingerprint;
+}
+
+OutputPtr OutputSnapshot::toOutput() const
+{
+    if (!d) {
+        return OutputPtr();
+    }
+    auto *dd = new Output::Private;
+    dd->shared = d->shared;
+    if (d->edid) {
+        dd->edid.reset(d->edid->clone());
+    }
+    dd->preferredMode = d->preferredModeId;
+    dd->identityFingerprint = d->identityFingerprint;
+    dd->stateFingerprint = d->stateFingerprint;
+    return OutputPtr(new Output(dd));
 }
 
 QDebug operator<<(QDebug dbg, const KScreen::OutputPtr &output)
@@ -22,6 +22,7 @@ namespace KScreen
 {
 class Edid;
 class Mode;
+class OutputSnapshot;
 
 class KSCREEN_EXPORT Output : public QObject
 {
@@ -109,6 +110,49 @@ public:
     };
     Q_ENUM(RgbRange)
 
+    /**
+     * Properties of an output that changed in apply()
+     * @since 6.0
+     */
+    enum class Change {
+        None = 0,
+        Name = 1 << 0, ///< name, type or icon
+        Position = 1 << 1,
+        Rotation = 1 << 2,
+        Scale = 1 << 3,
+        CurrentMode = 1 << 4,
+        Connected = 1 << 5,
+        Enabled = 1 << 6,
+        Priority = 1 << 7,
+        Clones = 1 << 8,
+        ReplicationSource = 1 << 9,
+        Modes = 1 << 10,
+        Capabilities = 1 << 11,
+        Overscan = 1 << 12,
+        VrrPolicy = 1 << 13,
+        RgbRange = 1 << 14,
+        Hdr = 1 << 15,
+        SdrBrightness = 1 << 16,
+        Wcg = 1 << 17,
+        /// Everything that can move or resize the output in the layout
+        Geometry = Position | Rotation | Scale | CurrentMode | Connected | Enabled | ReplicationSource | Modes,
+        /// Color and signal properties that leave the layout untouched
+        Color = Overscan | VrrPolicy | RgbRange | Hdr | SdrBrightness | Wcg,
+    };
+    Q_ENUM(Change)
+    Q_DECLARE_FLAGS(Changes, Change)
+    Q_FLAG(Changes)
+
+    /**
+     * What fingerprint() covers
+     * @since 6.0
+     */
+    enum class FingerprintScope {
+        Identity, ///< which display this is, the same information as hashMd5()
+        State, ///< the identity and every property that can be configured
+    };
+    Q_ENUM(FingerprintScope)
+
     explicit Output();
     ~Output() override;
 
@@ -144,6 +188,19 @@ public:
      */
     QString hashMd5() const;
 
+    /**
+     * Returns a 64-bit fingerprint of this output.
+     *
+     * It is much cheaper to compute than hashMd5() and cached until the output
+     * changes. The fingerprint is stable across sessions, but not a
+     * cryptographic hash. With FingerprintScope::State it also covers position,
+     * mode, rotation, scale, priority, replication and the color settings, but
+     * not the list of available modes.
+     *
+     * @since 6.0
+     */
+    quint64 fingerprint(FingerprintScope scope = FingerprintScope::Identity) const;
+
     Type type() const;
     QString typeName() const;
     void setType(Type type);
@@ -152,9 +209,36 @@ public:
     void setIcon(const QString &icon);
 
     Q_INVOKABLE ModePtr mode(const QString &id) const;
+    /**
+     * The Mode objects are created on the first call of mode(), modes(),
+     * currentMode() or preferredMode(). Use modeInfos() to only read the modes.
+     */
     ModeList modes() const;
     void setModes(const ModeList &modes);
 
+    /**
+     * Returns the modes as plain values, sorted by id, without creating
+     * Mode objects.
+     *
+     * @since 6.0
+     */
+    QList<ModeInfo> modeInfos() const;
+
+    /**
+     * @return the mode with the given id as plain value, or an invalid
+     * ModeInfo if the output has no such mode
+     * @since 6.0
+     */
+    ModeInfo modeInfo(const QString &id) const;
+
+    /**
+     * Sets the modes from plain values. This is what backends should use,
+     * Mode objects are only created if someone asks for them.
+     *
+     * @since 6.0
+     */
+    void setModeInfos(const QList<ModeInfo> &modes);
+
     QString currentModeId() const;
     void setCurrentModeId(const QString &mode);
     Q_INVOKABLE ModePtr currentMode() const;
@@ -443,7 +527,48 @@ public:
      */
     void setWcgEnabled(bool enable);
 
-    void apply(const OutputPtr &other);
+    /**
+     * Takes over all properties of @p other, emitting the change signals once
+     * everything is updated.
+     *
+     * @return the properties that actually changed (since 6.0)
+     */
+    Changes apply(const OutputPtr &other);
+
+    /**
+     * Compares this output with @p base without changing either.
+     *
+     * @return the properties apply() would change when applying this output
+     * to @p base
+     * @since 6.0
+     */
+    Changes diff(const OutputPtr &base) const;
+
+    /**
+     * Starts a batch of changes. Until the matching endUpdate() no change
+     * signals are emitted, endUpdate() then emits every signal at most once,
+     * and only for properties whose value differs from the one at
+     * beginUpdate(). Calls can be nested.
+     *
+     * @see Config::beginUpdate
+     * @since 6.0
+     */
+    void beginUpdate();
+
+    /**
+     * Ends a batch of changes started with beginUpdate().
+     * @since 6.0
+     */
+    void endUpdate();
+
+    /**
+     * Takes an immutable snapshot of the output, which can be used from other
+     * threads. The snapshot shares the data of the output until the output
+     * changes.
+     *
+     * @since 6.0
+     */
+    OutputSnapshot snapshot() const;
 
 Q_SIGNALS:
     void outputChanged();
@@ -482,14 +607,34 @@ private:
     Private *const d;
 
     explicit Output(Private *dd);
+
+    // Takes ownership of @p edid, for EDIDs parsed before
+    void adoptEdid(Edid *edid);
+
+    // Whether this output is in the same state as @p other because they still
+    // share their values
+    bool sharesState(const Output &other) const;
+    // Identifies the values, for grouping outputs that may share them
+    const void *stateData() const;
+    // Shares the values of @p leader, which was in the same state as this output
+    // before @p changes were applied to it, and emits the signals apply() would
+    void adoptState(const Output &leader, Changes changes);
+
+    friend class Config;
+    friend class EdidCache;
+    friend class OutputSnapshot;
+    friend class OutputSnapshotData;
 };
 
 } // KScreen namespace
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(KScreen::Output::Changes)
+
 KSCREEN_EXPORT QDebug operator<<(QDebug dbg, const KScreen::OutputPtr &output);
 
 Q_DECLARE_METATYPE(KScreen::OutputList)
 Q_DECLARE_METATYPE(KScreen::Output::Rotation)
 Q_DECLARE_METATYPE(KScreen::Output::Type)
+Q_DECLARE_METATYPE(KScreen::Output::Changes)
 
 #endif // OUTPUT_H
@@ -56,6 +56,11 @@ ScreenPtr Screen::clone() const
     return ScreenPtr(new Screen(new Private(*d)));
 }
 
+ScreenInfo Screen::info() const
+{
+    return ScreenInfo{d->id, d->currentSize, d->minSize, d->maxSize, d->maxActiveOutputsCount};
+}
+
 int Screen::id() const
 {
     return d->id;
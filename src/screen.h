@@ -15,6 +15,21 @@
 
 namespace KScreen
 {
+/**
+ * The properties of a Screen as a plain value.
+ *
+ * @since 6.0
+ */
+struct KSCREEN_EXPORT ScreenInfo {
+    int id = 0;
+    QSize currentSize;
+    QSize minSize;
+    QSize maxSize;
+    int maxActiveOutputsCount = 0;
+
+    bool operator==(const ScreenInfo &other) const = default;
+};
+
 class KSCREEN_EXPORT Screen : public QObject
 {
     Q_OBJECT
@@ -80,6 +95,12 @@ public:
 
     void apply(const ScreenPtr &other);
 
+    /**
+     * @return the properties of the screen as a value
+     * @since 6.0
+     */
+    ScreenInfo info() const;
+
 Q_SIGNALS:
     void currentSizeChanged();
 
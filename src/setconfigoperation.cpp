@@ -10,6 +10,7 @@
 #include "abstractbackend.h"
 #include "backendmanager_p.h"
 #include "config.h"
+#include "confighistory.h"
 #include "configoperation_p.h"
 #include "configserializer_p.h"
 #include "kscreen_debug.h"
@@ -17,6 +18,7 @@
 
 #include <QDBusPendingCall>
 #include <QDBusPendingCallWatcher>
+#include <QPointer>
 
 using namespace KScreen;
 
@@ -31,10 +33,16 @@ public:
 
     void backendReady(org::kde::kscreen::Backend *backend) override;
     void onConfigSet(QDBusPendingCallWatcher *watcher);
+    // Sends only the difference to the launcher's current config, if possible
+    QDBusPendingCallWatcher *sendConfigDelta(org::kde::kscreen::Backend *backend, uint wireCapabilities);
+    QDBusPendingCallWatcher *sendConfigBinary(org::kde::kscreen::Backend *backend, uint wireCapabilities);
     void normalizeOutputPositions();
     void fixPrimaryOutput();
 
     KScreen::ConfigPtr config;
+    bool binaryConfig = false;
+    bool deltaRequest = false;
+    QPointer<org::kde::kscreen::Backend> backend;
 
 private:
     Q_DECLARE_PUBLIC(SetConfigOperation)
@@ -60,33 +68,95 @@ void SetConfigOperationPrivate::backendReady(org::kde::kscreen::Backend *backend
         return;
     }
 
-    const QVariantMap map = ConfigSerializer::serializeConfig(config).toVariantMap();
-    if (map.isEmpty()) {
-        q->setError(tr("Failed to serialize request"));
-        q->emitResult();
-        return;
+    this->backend = backend;
+    const uint wireCapabilities = BackendManager::instance()->wireCapabilities();
+    binaryConfig = wireCapabilities & ConfigSerializer::BinaryConfig;
+    QDBusPendingCallWatcher *watcher = nullptr;
+    if (binaryConfig) {
+        watcher = sendConfigDelta(backend, wireCapabilities);
+        if (!watcher) {
+            watcher = sendConfigBinary(backend, wireCapabilities);
+        }
+        if (!watcher) {
+            q->setError(tr("Failed to serialize request"));
+            q->emitResult();
+            return;
+        }
+    } else {
+        if (!config) {
+            q->setError(tr("Failed to serialize request"));
+            q->emitResult();
+            return;
+        }
+        // Same a{sv} as serializeConfig(), but marshalled without the intermediate map
+        const QVariant arg = QVariant::fromValue(ConfigSerializer::DBusConfig{config});
+        watcher = new QDBusPendingCallWatcher(backend->asyncCallWithArgumentList(QStringLiteral("setConfig"), {arg}), this);
     }
-
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(backend->setConfig(map), this);
     connect(watcher, &QDBusPendingCallWatcher::finished, this, &SetConfigOperationPrivate::onConfigSet);
 }
 
+QDBusPendingCallWatcher *SetConfigOperationPrivate::sendConfigDelta(org::kde::kscreen::Backend *backend, uint wireCapabilities)
+{
+    if (!(wireCapabilities & ConfigSerializer::DeltaSetConfig) || !config) {
+        return nullptr;
+    }
+    // The config the launcher announced last, at the generation it is known by
+    const ConfigPtr base = BackendManager::instance()->config();
+    if (!base || base->serial() == 0) {
+        return nullptr;
+    }
+    // Nothing changed: still send the full config, so the backend re-applies it as before
+    const QByteArray delta = ConfigSerializer::serializeConfigDelta(base, config);
+    if (delta.isEmpty()) {
+        return nullptr;
+    }
+
+    deltaRequest = true;
+    return new QDBusPendingCallWatcher(backend->setConfigDelta(base->serial(), delta), this);
+}
+
+QDBusPendingCallWatcher *SetConfigOperationPrivate::sendConfigBinary(org::kde::kscreen::Backend *backend, uint wireCapabilities)
+{
+    deltaRequest = false;
+    const QByteArray data = ConfigSerializer::serializeConfigBinary(config, 0, wireCapabilities);
+    if (data.isEmpty()) {
+        return nullptr;
+    }
+    return new QDBusPendingCallWatcher(backend->setConfigV2(data), this);
+}
+
 void SetConfigOperationPrivate::onConfigSet(QDBusPendingCallWatcher *watcher)
 {
     Q_Q(SetConfigOperation);
 
-    QDBusPendingReply<QVariantMap> reply = *watcher;
     watcher->deleteLater();
 
-    if (reply.isError()) {
-        q->setError(reply.error().message());
+    if (watcher->isError() && deltaRequest && backend) {
+        // The launcher's config changed since we last heard of it, send everything
+        qCDebug(KSCREEN) << "Config delta rejected, sending the full config:" << watcher->error().message();
+        if (QDBusPendingCallWatcher *retry = sendConfigBinary(backend, BackendManager::instance()->wireCapabilities())) {
+            connect(retry, &QDBusPendingCallWatcher::finished, this, &SetConfigOperationPrivate::onConfigSet);
+            return;
+        }
+    }
+
+    if (watcher->isError()) {
+        q->setError(watcher->error().message());
         q->emitResult();
         return;
     }
 
-    config = ConfigSerializer::deserializeConfig(reply.value());
+    if (binaryConfig) {
+        const QDBusPendingReply<QByteArray> reply = *watcher;
+        config = ConfigSerializer::deserializeConfigBinary(reply.value());
+    } else {
+        const QDBusPendingReply<QVariantMap> reply = *watcher;
+        config = ConfigSerializer::deserializeConfig(reply.value());
+    }
     if (!config) {
         q->setError(tr("Failed to deserialize backend response"));
+    } else {
+        ConfigHistory::instance()->record(config, ConfigHistory::Origin::Applied);
     }
 
     q->emitResult();
@@ -115,6 +185,7 @@ void SetConfigOperation::start()
     if (BackendManager::instance()->method() == BackendManager::InProcess) {
         auto backend = d->loadBackend();
         backend->setConfig(d->config);
+        ConfigHistory::instance()->record(d->config, ConfigHistory::Origin::Applied);
         emitResult();
     } else {
         d->requestBackend();
@@ -23,6 +23,7 @@ typedef QMap<int, KScreen::OutputPtr> OutputList;
 class Mode;
 typedef QSharedPointer<KScreen::Mode> ModePtr;
 typedef QMap<QString, KScreen::ModePtr> ModeList;
+struct ModeInfo;
 
 }
 